@@ -0,0 +1,432 @@
+// wire.hpp micro-benchmarks. Build & run:
+// g++ bench/bench.cc -I. -std=c++11 -O2 -pthread -o wire.bench && ./wire.bench
+// (-std=c++17 adds the std::from_chars baselines)
+//
+// ./wire.bench --json results.json                  save every case as JSON ("-" for stdout; the table then
+//                                                    goes to stderr)
+// ./wire.bench --baseline results.json [--tolerance 15] [--runs 9]
+//                                                    compare against a saved run; exits 1 when any case got
+//                                                    slower than the tolerance (percent)
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#if defined(__has_include)
+#   if __has_include(<charconv>) && __cplusplus >= 201703L
+#       include <charconv>
+#   endif
+#endif
+
+#define WIRE_POSIX 1                                // reader maps files, builder::writev()
+#include "wire.hpp"
+
+namespace bench
+{
+    static volatile size_t sink;
+    static int runs = 5;
+    static FILE *table = stdout;
+    static std::vector< std::pair< std::string, double > > results;
+
+    // Returns nanoseconds per input byte (or per item, for the per-call cases), best of a few runs.
+    // Every run repeats fn for at least 2 ms, so that short cases are not lost in timer resolution
+    template< typename FN >
+    double per_byte( size_t bytes, const FN &fn ) {
+        double best = 1e30;
+        for( int run = 0; run < runs; ++run ) {
+            auto start = std::chrono::steady_clock::now(), end = start;
+            size_t calls = 0;
+            do sink += fn(), ++calls, end = std::chrono::steady_clock::now();
+            while( end - start < std::chrono::milliseconds( 2 ) );
+            double ns = std::chrono::duration<double, std::nano>( end - start ).count() / double( bytes ) / double( calls );
+            best = ns < best ? ns : best;
+        }
+        return best;
+    }
+
+    inline void report( const char *name, double ns_per_byte ) {
+        std::fprintf( table, "%-32s %8.3f ns/byte\n", name, ns_per_byte );
+        std::fflush( table );
+        results.push_back( std::make_pair( std::string( name ), ns_per_byte ) );
+    }
+
+    // One case per line, so runs diff well and load back without a JSON library
+    inline std::string json() {
+        std::string out = "{\n  \"unit\": \"ns/byte\",\n  \"results\": [\n";
+        for( size_t i = 0; i < results.size(); ++i ) {
+            std::string name;
+            for( char c : results[i].first ) {
+                if( c == '"' || c == '\\' ) name += '\\';
+                name += c;
+            }
+            out += wire::string( "    { \"name\": \"\1\", \"ns\": \2 }\3\n", name, wire::format( "%.6g", results[i].second ), i + 1 < results.size() ? "," : "" );
+        }
+        return out + "  ]\n}\n";
+    }
+
+    inline std::map< std::string, double > load( const char *path ) {
+        std::map< std::string, double > cases;
+        std::ifstream in( path );
+        for( std::string line; std::getline( in, line ); ) {
+            size_t at = line.find( "\"name\": \"" );
+            if( at == std::string::npos ) continue;
+            std::string name;
+            for( at += 9; at < line.size() && line[ at ] != '"'; ++at ) name += line[ at ] == '\\' && at + 1 < line.size() ? line[ ++at ] : line[ at ];
+            size_t ns = line.find( "\"ns\": ", at );
+            if( ns != std::string::npos ) cases[ name ] = std::strtod( line.c_str() + ns + 6, 0 );
+        }
+        return cases;
+    }
+
+    // Prints every case against the baseline; returns the number of regressions
+    inline int compare( const char *path, double tolerance ) {
+        std::map< std::string, double > base = load( path );
+        if( base.empty() ) return std::fprintf( stderr, "no baseline cases in %s\n", path ), 1;
+        int slower = 0;
+        std::fprintf( table, "\n%-32s %10s %10s %8s\n", "vs baseline", "before", "after", "change" );
+        for( const std::pair< std::string, double > &r : results ) {
+            std::map< std::string, double >::const_iterator found = base.find( r.first );
+            if( found == base.end() || found->second <= 0 ) continue;
+            double change = ( r.second / found->second - 1 ) * 100;
+            bool regressed = change > tolerance;
+            slower += regressed;
+            std::fprintf( table, "%-32s %10.3f %10.3f %+7.1f%%%s\n", r.first.c_str(), found->second, r.second, change, regressed ? "  REGRESSION" : "" );
+        }
+        std::fprintf( table, "%d case(s) slower than %.1f%%\n", slower, tolerance );
+        return slower;
+    }
+}
+
+int main( int argc, const char **argv )
+{
+    enum { MB = 1024 * 1024 };
+
+    const char *json = 0, *baseline = 0;
+    double tolerance = 15;
+    for( int i = 1; i < argc; i += 2 ) {
+        if( i + 1 == argc ) return std::fprintf( stderr, "%s: missing value\n", argv[i] ), 2;
+        if( !std::strcmp( argv[i], "--json" ) ) json = argv[i + 1];
+        else if( !std::strcmp( argv[i], "--baseline" ) ) baseline = argv[i + 1];
+        else if( !std::strcmp( argv[i], "--tolerance" ) ) tolerance = std::atof( argv[i + 1] );
+        else if( !std::strcmp( argv[i], "--runs" ) ) bench::runs = std::max( 1, std::atoi( argv[i + 1] ) );
+        else return std::fprintf( stderr, "usage: %s [--json file|-] [--baseline file] [--tolerance percent] [--runs n]\n", argv[0] ), 2;
+    }
+    if( json && !std::strcmp( json, "-" ) ) bench::table = stderr;
+
+    // baselines, per call: printf-style format(), safe formatting, and numbers to text vs the std equivalents
+    {
+        enum { N = 100000 };
+        char buf[ 64 ];
+        static const wire::fmt kv( "\1=\2;" );
+        bench::report( "snprintf() short", bench::per_byte( N, [&]{ size_t n = 0; for( int i = 0; i < N; ++i ) n += size_t( std::snprintf( buf, sizeof( buf ), "%s=%d;", "key", i ) ); return n; } ) );
+        bench::report( "format() short", bench::per_byte( N, [&]{ size_t n = 0; for( int i = 0; i < N; ++i ) n += wire::format( "%s=%d;", "key", i ).size(); return n; } ) );
+        bench::report( "std::string + to_string() short", bench::per_byte( N, [&]{ size_t n = 0; for( int i = 0; i < N; ++i ) n += ( std::string( "key" ) + "=" + std::to_string( i ) + ";" ).size(); return n; } ) );
+        bench::report( "formatsafe \\1=\\2; short", bench::per_byte( N, [&]{ size_t n = 0; for( int i = 0; i < N; ++i ) n += wire::string( "\1=\2;", "key", i ).size(); return n; } ) );
+        bench::report( "wire::fmt \\1=\\2; short", bench::per_byte( N, [&]{ size_t n = 0; for( int i = 0; i < N; ++i ) n += wire::string( kv, "key", i ).size(); return n; } ) );
+        bench::report( "std::to_string( int )", bench::per_byte( N, [&]{ size_t n = 0; for( int i = 0; i < N; ++i ) n += std::to_string( i * 7919 ).size(); return n; } ) );
+        bench::report( "wire::string( int )", bench::per_byte( N, [&]{ size_t n = 0; for( int i = 0; i < N; ++i ) n += wire::string( i * 7919 ).size(); return n; } ) );
+        bench::report( "std::to_string( double )", bench::per_byte( N, [&]{ size_t n = 0; for( int i = 0; i < N; ++i ) n += std::to_string( i * 0.25 ).size(); return n; } ) );
+        bench::report( "wire::string( double )", bench::per_byte( N, [&]{ size_t n = 0; for( int i = 0; i < N; ++i ) n += wire::string( i * 0.25 ).size(); return n; } ) );
+    }
+
+    // baselines, per token: as<int>/as<double> over short tokens vs strtol/strtod/std::from_chars
+    {
+        std::vector< wire::string > ints, reals;
+        for( unsigned i = 0; i < 100000; ++i ) ints.push_back( wire::string( i * 2654435761u % 1000000 ) ), reals.push_back( wire::string( "\1.\2", i % 5000, i % 997 ) );
+        bench::report( "strtol() short", bench::per_byte( ints.size(), [&]{ long n = 0; for( const wire::string &t : ints ) n += std::strtol( t.c_str(), 0, 10 ); return size_t( n ); } ) );
+        bench::report( "as<int>() short", bench::per_byte( ints.size(), [&]{ long n = 0; for( const wire::string &t : ints ) n += t.as<int>(); return size_t( n ); } ) );
+        bench::report( "strtod() short", bench::per_byte( reals.size(), [&]{ double n = 0; for( const wire::string &t : reals ) n += std::strtod( t.c_str(), 0 ); return size_t( n ); } ) );
+        bench::report( "as<double>() short", bench::per_byte( reals.size(), [&]{ double n = 0; for( const wire::string &t : reals ) n += t.as<double>(); return size_t( n ); } ) );
+#if defined(__cpp_lib_to_chars)
+        bench::report( "std::from_chars( int ) short", bench::per_byte( ints.size(), [&]{ long n = 0; int v = 0; for( const wire::string &t : ints ) std::from_chars( t.data(), t.data() + t.size(), v ), n += v; return size_t( n ); } ) );
+        bench::report( "std::from_chars( double ) short", bench::per_byte( reals.size(), [&]{ double n = 0, v = 0; for( const wire::string &t : reals ) std::from_chars( t.data(), t.data() + t.size(), v ), n += v; return size_t( n ); } ) );
+#endif
+    }
+
+    // baselines: 4 KB CSV lines tokenized vs a find_first_of() loop; 100 MB count()/replace() vs find() loops
+    {
+        wire::string line;
+        while( line.size() < 4096 ) line += "1024,john doe,42,madrid;";
+        wire::strings fields;
+        std::vector< std::string > parts;
+        bench::report( "find_first_of() loop 4KB line", bench::per_byte( line.size(), [&]{
+            parts.clear();
+            for( size_t from = 0, to; from < line.size(); from = to + 1 ) {
+                to = line.find_first_of( ",;", from );
+                if( to == std::string::npos ) to = line.size();
+                if( to > from ) parts.push_back( line.substr( from, to - from ) );
+            }
+            return parts.size();
+        } ) );
+        bench::report( "wire::tokenize(into) 4KB line", bench::per_byte( line.size(), [&]{ return wire::tokenize( line, ",;", fields ); } ) );
+
+        wire::string text;
+        while( text.size() < 100u * MB ) text += "GET /index.html 200 ERROR timeout, retrying\n";
+        bench::report( "std::string::find() loop 100MB", bench::per_byte( text.size(), [&]{
+            size_t n = 0;
+            for( size_t at = text.find( "ERROR" ); at != std::string::npos; at = text.find( "ERROR", at + 5 ) ) n++;
+            return n;
+        } ) );
+        bench::report( "count() 100MB", bench::per_byte( text.size(), [&]{ return text.count( "ERROR" ); } ) );
+        bench::report( "std::string replace loop 100MB", bench::per_byte( text.size(), [&]{
+            std::string out;
+            size_t from = 0;
+            for( size_t at; ( at = text.find( "ERROR", from ) ) != std::string::npos; from = at + 5 ) out.append( text, from, at - from ).append( "WARN" );
+            return out.append( text, from, std::string::npos ).size();
+        } ) );
+        bench::report( "replace() 100MB", bench::per_byte( text.size(), [&]{ return text.replace( "ERROR", "WARN" ).size(); } ) );
+    }
+
+    // strip(): 1 MB payload surrounded by 1 MB of padding on each side
+    {
+        wire::string spaces( std::string( MB, ' ' ) + std::string( MB, 'x' ) + std::string( MB, ' ' ) );
+        wire::string dashes( std::string( MB, '-' ) + std::string( MB, 'x' ) + std::string( MB, '=' ) );
+        bench::report( "strip() spaces 3MB", bench::per_byte( spaces.size(), [&]{ return spaces.strip().size(); } ) );
+        bench::report( "strip(\"-=\") 3MB", bench::per_byte( dashes.size(), [&]{ return dashes.strip( "-=" ).size(); } ) );
+    }
+
+    // strip(), per call: short header tokens, where per-call setup dominates
+    {
+        enum { N = 10000 };
+        wire::string header( "  Content-Length  " ), dashed( "- Content-Length -" );
+        bench::report( "strip() spaces, short", bench::per_byte( N, [&]{ size_t n = 0; for( int i = 0; i < N; ++i ) n += header.view().strip().size(); return n; } ) );
+        bench::report( "strip(\"- \"), short", bench::per_byte( N, [&]{ size_t n = 0; for( int i = 0; i < N; ++i ) n += dashed.view().strip( "- " ).size(); return n; } ) );
+    }
+
+    // replace_map(): 1 MB of text with a small entity escaping table
+    {
+        std::map< std::string, std::string > entities;
+        entities[ "&" ] = "&amp;", entities[ "<" ] = "&lt;", entities[ ">" ] = "&gt;", entities[ "\"" ] = "&quot;";
+        wire::string text;
+        while( text.size() < MB ) text += "if( a < b && c > \"d\" ) return lorem ipsum dolor sit amet; ";
+        bench::report( "replace_map() 1MB", bench::per_byte( text.size(), [&]{ return text.replace_map( entities ).size(); } ) );
+
+        // 2000-entry table
+        std::map< std::string, std::string > table;
+        for( unsigned i = 0; table.size() < 2000; ++i ) {
+            std::string word;
+            for( unsigned n = i * 2654435761u, len = 3 + n % 6; word.size() < len; n /= 7 ) word += char( 'a' + n % 26 );
+            table[ word ] = "<" + word + ">";
+        }
+        table[ "lorem" ] = "LOREM";
+        bench::report( "replace_map() 2000 entries 1MB", bench::per_byte( text.size(), [&]{ return text.replace_map( table ).size(); } ) );
+        const wire::replacer compiled( table );
+        bench::report( "replacer 2000 entries 1MB", bench::per_byte( text.size(), [&]{ return text.replace_map( compiled ).size(); } ) );
+    }
+
+    // tokenize(): a single long token, grown one char at a time
+    {
+        wire::string token( std::string( 64 * 1024, 'x' ) + "," );
+        bench::report( "tokenize() 64KB token", bench::per_byte( token.size(), [&]{ return token.tokenize( "," ).size(); } ) );
+    }
+
+    // CSV-like 1 MB: eager deque, lazy ranges, and eager into a reused wire::strings
+    {
+        wire::string csv;
+        while( csv.size() < MB ) csv += "1024,john doe,42,madrid;";
+        wire::strings fields;
+        bench::report( "tokenize() CSV 1MB", bench::per_byte( csv.size(), [&]{ return csv.tokenize( ",;" ).size(); } ) );
+        bench::report( "wire::tokens CSV 1MB", bench::per_byte( csv.size(), [&]{ return wire::tokens( csv, ",;" ).size(); } ) );
+        bench::report( "wire::tokenize(into) CSV 1MB", bench::per_byte( csv.size(), [&]{ return wire::tokenize( csv, ",;", fields ); } ) );
+    }
+
+    // ~1M tokens into a fresh container each run, destruction included: wire::strings vs wire::string_table vs small strings
+    {
+        wire::string words;
+        while( words.size() < 8 * MB ) words += "a-longer-than-sso-token,";
+        bench::report( "tokenize() 8MB -> strings", bench::per_byte( words.size(), [&]{ wire::strings out; return wire::tokenize( words, ",", out ); } ) );
+        bench::report( "tokenize() 8MB -> string_table", bench::per_byte( words.size(), [&]{ wire::string_table out; return wire::tokenize( words, ",", out ); } ) );
+        bench::report( "tokenize() 8MB -> small_strings", bench::per_byte( words.size(), [&]{ std::vector< wire::small_string<32> > out; return wire::tokenize( words, ",", out ); } ) );
+    }
+
+    // delimiter scanning: 4 and 16 delimiters over 1 MB of sparse tokens, and a dense 1-byte count()
+    {
+        wire::string text;
+        while( text.size() < MB ) text += "lorem-ipsum-dolor-sit-amet-consectetur-adipiscing|";
+        const wire::charset four( "|,;\t" ), sixteen( "|,;\t!\"#$%&'()*+/:" );
+        bench::report( "charset(4)::find 1MB", bench::per_byte( text.size(), [&]{ return wire::tokens( text, four ).size(); } ) );
+        bench::report( "charset(16)::find 1MB", bench::per_byte( text.size(), [&]{ return wire::tokens( text, sixteen ).size(); } ) );
+        bench::report( "count(\"-\") 1MB", bench::per_byte( text.size(), [&]{ return text.count( "-" ); } ) );
+    }
+
+    // uppercase() 1MB, and case-insensitive prefix checks over a 64 KB body
+    {
+        wire::string text;
+        while( text.size() < MB ) text += "Lorem Ipsum Dolor Sit Amet 0123456789 ";
+        wire::string body( std::string( 64 * 1024, 'x' ) );
+        bench::report( "uppercase() 1MB", bench::per_byte( text.size(), [&]{ return text.uppercase().size(); } ) );
+        bench::report( "starts_withi() 64KB body", bench::per_byte( 8, [&]{ return size_t( body.starts_withi( "XXXXXXXX" ) ); } ) );
+    }
+
+    // matches(): adversarial glob over a 4 KB line, recompiled and precompiled
+    {
+        wire::string line( std::string( 4096, 'a' ) );
+        const wire::pattern compiled( "*a*a*a*a*a*a*b" );
+        bench::report( "matches() *a*a*a*a*a*a*b 4KB", bench::per_byte( line.size(), [&]{ return size_t( line.matches( "*a*a*a*a*a*a*b" ) ); } ) );
+        bench::report( "pattern::matches() same", bench::per_byte( line.size(), [&]{ return size_t( compiled.matches( line ) ); } ) );
+        const wire::pattern wild( "*?*?*?*?*?*?*?*?*?*?*?*?*?*?*?*c" );
+        bench::report( "pattern::matches() 15x *? 4KB", bench::per_byte( line.size(), [&]{ return size_t( wild.matches( line ) ); } ) );
+    }
+
+    // replace(): "\n" -> "\r\n" over 1 MB of short lines, and a long-needle count()
+    {
+        wire::string text;
+        while( text.size() < MB ) text += "short line of text\n";
+        const std::string needle = "line of text, then something else";
+        bench::report( "replace(\\n, \\r\\n) 1MB", bench::per_byte( text.size(), [&]{ return text.replace( "\n", "\r\n" ).size(); } ) );
+        bench::report( "count() 33-byte needle 1MB", bench::per_byte( text.size(), [&]{ return text.count( needle ); } ) );
+        bench::report( "count() same, naive", bench::per_byte( text.size(), [&]{ return text.count( needle, wire::search::naive ); } ) );
+    }
+
+    // temporaries: a copy of 1 MB chained through replace().strip().uppercase(), and << of std::string temporaries
+    {
+        wire::string text;
+        while( text.size() < MB ) text += "  lorem ipsum dolor sit amet  ";
+        const std::string chunk( 64, 'x' );
+        bench::report( "copy.replace().strip() 1MB", bench::per_byte( text.size(), [&]{ return wire::string( text ).replace( "o", "0" ).strip().uppercase().size(); } ) );
+        bench::report( "<< std::string temporaries 1MB", bench::per_byte( MB, [&]{ wire::string out; while( out.size() < MB ) out << std::string( chunk ) << '\n'; return out.size(); } ) );
+    }
+
+    // operator<< chains of literals, integers and reals into a ~1 MB log
+    {
+        bench::report( "<< log line chain 1MB", bench::per_byte( MB, [&]{
+            wire::string out;
+            for( unsigned i = 0; out.size() < MB; ++i ) out.reserve_hint( 64 ) << "id=" << i << " ts=" << 1234567.25 * i << " ok" << std::endl;
+            return out.size();
+        } ) );
+    }
+
+    // dumping a 100k-entry map and a 100k wire::strings to text
+    {
+        std::map< std::string, int > stock;
+        for( int i = 0; stock.size() < 100000; ++i ) stock[ wire::string( "item-\1", i * 7919 ) ] = i;
+        wire::strings lines( wire::strings( std::vector< std::string >( 100000, "lorem ipsum dolor sit amet" ) ) );
+        size_t bytes = wire::str12( stock, "\1=\2\n" ).size(), text = lines.str().size();
+        bench::report( "str12() 100k map", bench::per_byte( bytes, [&]{ return wire::str12( stock, "\1=\2\n" ).size(); } ) );
+        bench::report( "strings::str() 100k", bench::per_byte( text, [&]{ return lines.str().size(); } ) );
+    }
+
+    // batch conversion and transform over 1M strings: serial vs the shared pool
+    {
+        wire::strings values;
+        for( unsigned i = 0; i < 1000000; ++i ) values.push_back( wire::string( "\1.\2", i, i % 1000 ) );
+        size_t bytes = values.str( "\1" ).size();
+        std::vector< double > out;
+        wire::pool serial( 1 );
+        bench::report( "as_all<double> 1M serial", bench::per_byte( bytes, [&]{ return values.as_all( out, serial ); } ) );
+        bench::report( "as_all<double> 1M pool", bench::per_byte( bytes, [&]{ return values.as_all( out ); } ) );
+        bench::report( "transform(uppercase) 1M serial", bench::per_byte( bytes, [&]{ wire::strings copy( values ); return copy.transform( []( wire::string &s ) { s = s.uppercase(); }, serial ).size(); } ) );
+        bench::report( "transform(uppercase) 1M pool", bench::per_byte( bytes, [&]{ wire::strings copy( values ); return copy.transform( []( wire::string &s ) { s = s.uppercase(); } ).size(); } ) );
+    }
+
+    // one 64 MB buffer: serial count/replace/tokenize vs wire::parallel on the shared pool
+    {
+        wire::string text;
+        while( text.size() < 64u * MB ) text += "GET /index.html 200 ERROR timeout, retrying\n";
+        bench::report( "count() 64MB", bench::per_byte( text.size(), [&]{ return text.count( "ERROR" ); } ) );
+        bench::report( "parallel::count() 64MB", bench::per_byte( text.size(), [&]{ return wire::parallel::count( text, "ERROR" ); } ) );
+        bench::report( "replace() 64MB", bench::per_byte( text.size(), [&]{ return text.replace( "ERROR", "WARN" ).size(); } ) );
+        bench::report( "parallel::replace() 64MB", bench::per_byte( text.size(), [&]{ return wire::parallel::replace( text, "ERROR", "WARN" ).size(); } ) );
+        bench::report( "tokenize() views 64MB", bench::per_byte( text.size(), [&]{ return text.view().tokenize( " ,\n" ).size(); } ) );
+        bench::report( "parallel::tokenize() 64MB", bench::per_byte( text.size(), [&]{ return wire::parallel::tokenize( text, " ,\n" ).size(); } ) );
+    }
+
+    // repeated keys: wire::string == std::string, and an unordered_map keyed by strings vs atoms
+    {
+        std::vector< wire::string > names;
+        for( unsigned i = 0; i < 4096; ++i ) names.push_back( wire::string( "x-metric-name-\1.count", i % 512 ) );
+        std::string probe( names[7] );
+        std::unordered_map< wire::string, int > by_name;
+        std::unordered_map< wire::atom, int > by_atom;
+        std::vector< wire::atom > atoms;
+        for( const wire::string &n : names ) by_name[ n ]++, atoms.push_back( wire::atom( n ) ), by_atom[ atoms.back() ]++;
+        bench::report( "== std::string 4k keys", bench::per_byte( names.size(), [&]{ size_t n = 0; for( const wire::string &s : names ) n += s == probe; return n; } ) );
+        bench::report( "unordered_map<string> 4k", bench::per_byte( names.size(), [&]{ size_t n = 0; for( const wire::string &s : names ) n += by_name.find( s )->second; return n; } ) );
+        bench::report( "unordered_map<atom> 4k", bench::per_byte( names.size(), [&]{ size_t n = 0; for( const wire::atom &a : atoms ) n += by_atom.find( a )->second; return n; } ) );
+    }
+
+    // checkpointing doubles: precise() strings vs precise_to()/precise_from() on a stack buffer
+    {
+        std::vector< double > values;
+        for( unsigned i = 0; i < 100000; ++i ) values.push_back( ( i * 2654435761u % 1000003 ) / 7.0 - 50000 );
+        std::vector< std::string > texts;
+        for( double v : values ) texts.push_back( wire::precise( v ) );
+        bench::report( "precise() 100k doubles", bench::per_byte( values.size(), [&]{ size_t n = 0; for( double v : values ) n += wire::precise( v ).size(); return n; } ) );
+        bench::report( "precise_to() 100k doubles", bench::per_byte( values.size(), [&]{ char buf[ wire::precise_max ]; size_t n = 0; for( double v : values ) n += wire::precise_to( buf, sizeof( buf ), v ); return n; } ) );
+        bench::report( "precise(string) 100k", bench::per_byte( texts.size(), [&]{ long double sum = 0; for( const std::string &t : texts ) sum += wire::precise( t ); return size_t( sum != 0 ); } ) );
+        bench::report( "precise_from() 100k", bench::per_byte( texts.size(), [&]{ double v, sum = 0; for( const std::string &t : texts ) wire::precise_from( t.data(), t.data() + t.size(), v ), sum += v; return size_t( sum != 0 ); } ) );
+    }
+
+    // 32 MB document out of 64k records (formatted prefix + shared 512-byte body), and 64k prepends
+    {
+        const std::string body( 512, 'b' );
+        static const wire::fmt record( "<row id=\"\1\" name=\"\2\">" );
+        const size_t bytes = 65536 * ( body.size() + 30 );
+        bench::report( "document wire::string <<", bench::per_byte( bytes, [&]{
+            wire::string doc;
+            for( unsigned i = 0; i < 65536; ++i ) record.append( doc, i, "user" ) << body;
+            return doc.size();
+        } ) );
+        bench::report( "document builder str()", bench::per_byte( bytes, [&]{
+            wire::builder doc;
+            for( unsigned i = 0; i < 65536; ++i ) doc.format( record, i, "user" ).append_ref( body );
+            return doc.str().size();
+        } ) );
+        if( FILE *null = std::fopen( "/dev/null", "wb" ) ) {
+            bench::report( "document wire::string fwrite", bench::per_byte( bytes, [&]{
+                wire::string doc;
+                for( unsigned i = 0; i < 65536; ++i ) record.append( doc, i, "user" ) << body;
+                return std::fwrite( doc.data(), 1, doc.size(), null );
+            } ) );
+            bench::report( "document builder writev", bench::per_byte( bytes, [&]{
+                wire::builder doc;
+                for( unsigned i = 0; i < 65536; ++i ) doc.format( record, i, "user" ).append_ref( body );
+                return doc.writev( fileno( null ) );
+            } ) );
+            std::fclose( null );
+        }
+        bench::report( "prepend 64k wire::string", bench::per_byte( 65536, [&]{
+            wire::string doc;
+            for( unsigned i = 0; i < 65536; ++i ) doc.insert( 0, "line\n" );
+            return doc.size();
+        } ) );
+        bench::report( "prepend 64k builder str()", bench::per_byte( 65536, [&]{
+            wire::builder doc;
+            for( unsigned i = 0; i < 65536; ++i ) doc.prepend( "line\n", 5 );
+            return doc.str().size();
+        } ) );
+    }
+
+    // wire::reader over a 64 MB temporary file: mapped tokens and lines, streamed tokens
+    {
+        const char *path = "wire.bench.reader.tmp";
+        const std::string row = "1024,john doe,42,madrid\n";
+        if( FILE *fp = std::fopen( path, "wb" ) ) {
+            for( size_t n = 0; n < 64u * MB; n += row.size() ) std::fwrite( row.data(), 1, row.size(), fp );
+            std::fclose( fp );
+            bench::report( "reader tokens mapped 64MB", bench::per_byte( 64 * MB, [&]{ wire::reader in( path ); size_t n = 0; for( wire::string_view t : in.tokens( ",\n" ) ) n += t.size(); return n; } ) );
+            bench::report( "reader lines mapped 64MB", bench::per_byte( 64 * MB, [&]{ wire::reader in( path ); size_t n = 0; for( wire::string_view l : in.lines() ) n += l.size(); return n; } ) );
+            bench::report( "reader tokens streamed 64MB", bench::per_byte( 64 * MB, [&]{
+                FILE *in = std::fopen( path, "rb" );
+                size_t n = 0;
+                { wire::reader streamed( in ); for( wire::string_view t : streamed.tokens( ",\n" ) ) n += t.size(); }
+                return std::fclose( in ), n;
+            } ) );
+            std::remove( path );
+        }
+    }
+
+    if( json ) {
+        std::string out = bench::json();
+        if( !std::strcmp( json, "-" ) ) std::fputs( out.c_str(), stdout );
+        else if( !( std::ofstream( json ) << out ) ) return std::fprintf( stderr, "cannot write %s\n", json ), 2;
+    }
+    return baseline && bench::compare( baseline, tolerance ) ? 1 : 0;
+}
@@ -10,7 +10,7 @@ int main( int argc, const char **argv )
     wire::string minusone = -1;                                 // -> "-1"
     wire::string zero = 0;                                      // -> "0"
     wire::string boolean = false;                               // -> "false"
-    wire::string real = 3.1415926535897932384626433832795L;     // ~-> "3.14159"
+    wire::string real = 3.1415926535897932384626433832795L;     // ~-> "3.1415926535897932385"
     }
 
     /* safe c++ constructors */ {
@@ -1,12 +1,61 @@
+#include <atomic>
 #include <cassert>
 #include <cmath>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <unordered_set>
 
 #include <iostream>
 
+// reader maps files, builder writev()s (build with -DWIRE_POSIX=0 to test without them)
+#ifndef WIRE_POSIX
+#define WIRE_POSIX 1
+#endif
 #include "wire.hpp"
 
 std::stringstream right, wrong;
 
+// counts every heap allocation, for the no-extra-allocation tests
+static std::atomic< size_t > allocations( 0 );
+
+// array forms too, so every new/delete pair goes through the same malloc/free. Once inlined, gcc 11+ sees free()
+// on the result of operator new and warns (-Wmismatched-new-delete), although the pair matches
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#   pragma GCC diagnostic push
+#   pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void *operator new( size_t n ) {
+    ++allocations;
+    if( void *p = std::malloc( n ? n : 1 ) ) return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[]( size_t n ) {
+    return operator new( n );
+}
+
+void operator delete( void *p ) noexcept {
+    std::free( p );
+}
+
+void operator delete[]( void *p ) noexcept {
+    operator delete( p );
+}
+
+#if __cpp_sized_deallocation
+void operator delete( void *p, size_t ) noexcept {
+    operator delete( p );
+}
+
+void operator delete[]( void *p, size_t ) noexcept {
+    operator delete( p );
+}
+#endif
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#   pragma GCC diagnostic pop
+#endif
+
 #define test1(A) [&]() { auto _A_ = (A); if( _A_ != decltype(A)(0) ) \
     return right << "[ OK ] " __FILE__ ":" << __LINE__ << " -> " #A " -> " << _A_ << std::endl, true; else \
     return wrong << "[FAIL] " __FILE__ ":" << __LINE__ << " -> " #A " -> " << _A_ << std::endl, false; \
@@ -41,6 +90,35 @@ struct ctest_stream2
     {}
 };
 
+struct ctest_point
+{
+    int x, y;
+};
+
+std::ostream &operator<<( std::ostream &os, const ctest_point &p ) {
+    return os << p.x << ',' << p.y;
+}
+
+// leaves the stream in hex on purpose
+struct ctest_hex
+{
+    int value;
+};
+
+std::ostream &operator<<( std::ostream &os, const ctest_hex &h ) {
+    return os << std::hex << h.value;
+}
+
+// formats through wire itself, while the outer fallback stream is in use
+struct ctest_nested
+{
+    ctest_point p;
+};
+
+std::ostream &operator<<( std::ostream &os, const ctest_nested &n ) {
+    return os << wire::string( "(\1)", n.p );
+}
+
 void tests_from_string_sample()
 {
     /* many constructors */ {
@@ -51,7 +129,7 @@ void tests_from_string_sample()
     wire::string minusone = -1;                                 // -> "-1"
     wire::string zero = 0;                                      // -> "0"
     wire::string boolean = false;                               // -> "false"
-    wire::string real = 3.1415926535897932384626433832795L;     // ~-> "3.14159"
+    wire::string real = 3.1415926535897932384626433832795L;     // ~-> "3.1415926535897932385"
 
     test3( helloworld ,==, "hello world" );
     test3( h          ,==, "h" );
@@ -60,7 +138,11 @@ void tests_from_string_sample()
     test3( minusone   ,==, "-1" );
     test3( zero       ,==, "0" );
     test3( boolean    ,==, "false" );
+#if WIRE_COMPAT_PRECISION
     test3( real       ,==, "3.14159" );
+#else
+    test3( real.as<long double>(), ==, 3.1415926535897932384626433832795L );
+#endif
     }
 
     /* safe c++ constructors */ {
@@ -139,6 +221,7 @@ void tests_from_string_sample()
     test3( echo, ==, "health=100;money=123.25;hello=world!;" );
 
     test3( std::string(), ==, $wire("", 0) );
+    test3( std::string(), ==, $wire("\1=\2;") );
     }
 }
 
@@ -146,11 +229,122 @@ int main( int argc, const char **argv )
 {
     // tools
     test3( wire::format("%d %1.3f %s", 10, 3.14159f, "hello world"), ==, "10 3.142 hello world" );
+    test3( wire::format("%s", std::string(1000, 'x').c_str()), ==, std::string(1000, 'x') );
+    test3( wire::format("%0600d|", 7).size(), ==, 601 );
+    {
+        std::string buf;
+        test3( wire::format_to(buf, "%d-%d", 1, 2), ==, "1-2" );
+        test3( wire::format_to(buf, "%s", "abc"), ==, "abc" );
+        test3( wire::format_append(buf, "%d", 4), ==, "abc4" );
+        test3( wire::format_append(buf, "%0600d", 5).size(), ==, 604 );
+        test3( buf.substr(0, 5), ==, "abc40" );
+        test3( buf.back(), ==, '5' );
+    }
+    {
+        // arguments pointing into the destination, longer than the stack buffer
+        std::string self( 600, 'a' ), again( 600, 'b' );
+        test3( wire::format_append( self, "%s", self.c_str() ), ==, std::string( 1200, 'a' ) );
+        test3( wire::format_to( again, "%s!", again.c_str() ), ==, std::string( 600, 'b' ) + "!" );
+        test3( wire::format_to( again, "%.3s", again.c_str() ), ==, "bbb" );
+    }
 
     test3( wire::string(99.95f), ==, "99.95" );
+    test3( wire::string(0.1), ==, "0.1" );
+    test3( wire::string(0.1f), ==, "0.1" );
+    test3( wire::string(123.25f), ==, "123.25" );
+    test3( wire::string(1e100), ==, "1e+100" );
+    test3( wire::string(-2.5e-8), ==, "-2.5e-08" );
+#if !WIRE_COMPAT_PRECISION
+    test3( wire::string(1/3.0), ==, "0.3333333333333333" );
+    test3( wire::string(0.1+0.2), ==, "0.30000000000000004" );
+#endif
+    test3( wire::string(std::numeric_limits<double>::infinity()), ==, "inf" );
+    test3( wire::string(std::numeric_limits<int>::min()), ==, "-2147483648" );
+    test3( wire::string(std::numeric_limits<long long>::min()), ==, "-9223372036854775808" );
+    test3( wire::string(std::numeric_limits<unsigned long long>::max()), ==, "18446744073709551615" );
+    test3( wire::string((short)-5), ==, "-5" );
+    test3( wire::string((unsigned short)65535), ==, "65535" );
+    test3( wire::string(1234567u), ==, "1234567" );
+    test3( wire::string(-90l), ==, "-90" );
+    {
+        char buf[ 64 ];
+        test3( std::string( buf, wire::format_real( buf, 3.1415926535897932384626433832795L, true ) ), ==, "3.14159" );
+        test3( std::string( buf, wire::format_real( buf, 1/3.0, true ) ), ==, "0.333333" );
+    }
     test3( wire::string(999.9999), ==, 999.9999 );
     test3( wire::precise(999.9999f), ==, "0x1.f3fffcp+9" );
-    test3( wire::precise("0x1.f3fffcp+9"), ==, 999.9999 );
+    test3( wire::precise("0x1.f3fffcp+9"), ==, 999.9999f );
+    {
+        // precise(): bit-exact round trips over random bit patterns, glibc's %a layout, rounding of longer inputs
+        uint64_t seed = 88172645463325252ull;
+        auto next = [&]{ seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17; return seed; };
+        char buf[ wire::precise_max ], ref[ 64 ], *end;
+        size_t doubles = 0, floats = 0, longs = 0, layout = 0, rounded = 0, runs = 100000;
+        for( size_t i = 0; i < runs; ++i ) {
+            uint64_t bits = next();
+            if( i % 5 == 0 ) bits &= 0x800fffffffffffffull;                                  // subnormals
+            if( i % 97 == 0 ) bits |= 0x7ff0000000000000ull, bits &= i % 2 ? ~0ull : 0xfff0000000000000ull;    // NaNs, infinities
+            double d, d2;
+            std::memcpy( &d, &bits, 8 );
+            size_t len = wire::precise_to( buf, sizeof( buf ), d );
+            doubles += wire::precise_from( buf, buf + len, d2 ) && ( d != d ? d2 != d2 : !std::memcmp( &d, &d2, 8 ) );
+
+            uint32_t bits32 = uint32_t( bits >> 32 );
+            float f, f2;
+            std::memcpy( &f, &bits32, 4 );
+            len = wire::precise_to( buf, sizeof( buf ), f );
+            floats += wire::precise_from( buf, buf + len, f2 ) && ( f != f ? f2 != f2 : !std::memcmp( &f, &f2, 4 ) );
+
+            long double ld = std::ldexp( (long double)( next() | 1 ), int( next() % 32700 ) - 16350 - 64 ), ld2;
+            if( i % 7 == 0 ) ld = std::ldexp( (long double)( next() >> ( next() % 64 ) ), std::numeric_limits< long double >::min_exponent - std::numeric_limits< long double >::digits );
+            if( i % 2 ) ld = -ld;
+            len = wire::precise_to( buf, sizeof( buf ), ld );
+            longs += wire::precise_from( buf, buf + len, ld2 ) && ld == ld2 && std::signbit( ld ) == std::signbit( ld2 );
+
+            // 17..20 random nibbles: more bits than a double holds, rounded as strtod/strtof do
+            std::string hex = wire::string( "0x\1.", "123456789abcdef"[ next() % 15 ] );
+            for( size_t n = 16 + next() % 4; n--; ) hex += "0123456789abcdef"[ next() % 16 ];
+            hex += wire::string( "p\1", int( next() % 300 ) - 1200 + ( i % 3 ) * 1000 );
+            wire::precise_from( hex.data(), hex.data() + hex.size(), d2 );
+            wire::precise_from( hex.data(), hex.data() + hex.size(), f2 );
+            rounded += d2 == std::strtod( hex.c_str(), &end ) && f2 == std::strtof( hex.c_str(), &end );
+#ifdef __GLIBC__
+            if( d == d && d - d == 0 ) {
+                std::snprintf( ref, sizeof( ref ), "%a", d );
+                layout += std::string( buf, wire::precise_to( buf, sizeof( buf ), d ) ) == ref;
+                std::snprintf( ref, sizeof( ref ), "%La", ld );
+                layout += std::string( buf, wire::precise_to( buf, sizeof( buf ), ld ) ) == ref;
+            } else layout += 2;
+#else
+            layout += 2;
+#endif
+        }
+        test3( doubles, ==, runs );
+        test3( floats, ==, runs );
+        test3( longs, ==, runs );
+        test3( rounded, ==, runs );
+        test3( layout, ==, 2 * runs );
+
+        test3( wire::precise( std::numeric_limits< double >::infinity() ), ==, "INF" );
+        test3( wire::precise( -std::numeric_limits< float >::infinity() ), ==, "-INF" );
+        test3( wire::precise( std::numeric_limits< double >::quiet_NaN() ), ==, "NaN" );
+        testN( wire::precise( "NaN" ) );
+        test3( wire::precise( "-INF" ), ==, -std::numeric_limits< long double >::infinity() );
+        test3( wire::precise( -0.0 ), ==, "-0x0p+0" );
+        test3( wire::precise( 3 ), ==, "0xcp-2" );
+        test3( wire::precise( "  -0x1p-2 trailing" ), ==, -0.25 );
+        test3( wire::precise( "1.5" ), ==, 1.5 );
+        test3( wire::precise( "junk" ), ==, 0 );
+        double parsed = 7;
+        test3( wire::precise_from( "junk", "junk" + 4, parsed ), ==, false );
+        test3( parsed, ==, 7 );
+        test3( wire::precise_to( buf, 5, 999.9999 ), ==, 0 );
+        float tie, above;
+        wire::precise_from( "0x1.000001p+0", "0x1.000001p+0" + 13, tie );
+        wire::precise_from( "0x1.0000011p+0", "0x1.0000011p+0" + 14, above );
+        test3( tie, ==, 1.0f );
+        test3( above, ==, 1.0f + std::numeric_limits< float >::epsilon() );
+    }
 
     test3( wire::string().strip(), ==, wire::string() );
     test3( wire::string("").strip(), ==, wire::string() );
@@ -172,6 +366,35 @@ int main( int argc, const char **argv )
     test3( wire::string("a b c ").lstrip(), ==, "a b c " );
     test3( wire::string(" a b c ").lstrip(), ==, "a b c " );
 
+    test3( wire::string("   ").strip(), ==, "" );
+    test3( wire::string("   ").rstrip(), ==, "" );
+    test3( wire::string("\t\n x \r").strip(), ==, "x" );
+    test3( wire::string("--x-=").strip("-="), ==, "x" );
+    test3( wire::string("--x-=").lstrip("-="), ==, "x-=" );
+    test3( wire::string("--x-=").rstrip("-="), ==, "--x" );
+    test3( wire::string("-=-=").strip("-="), ==, "" );
+    test3( wire::string( std::string( 70, '-' ) + "x" + std::string( 70, '=' ) ).strip("-="), ==, "x" );
+    test3( wire::string( std::string( 70, ' ' ) + "x\t" ).strip(), ==, "x" );
+    test3( wire::string("Hi!").at_unchecked(1), ==, 'i' );
+
+    {
+        wire::string pushed( "b" );
+        pushed.push_front( 'a' );
+        pushed.push_back( 'c' );
+        pushed.push_front( std::string("<") );
+        pushed.push_back( ">" );
+        pushed.push_back( 12 );
+        pushed.push_front( -3.5 );
+        pushed.push_back( true );
+        pushed.push_front( pushed );
+        test3( pushed, ==, "-3.5<abc>12true-3.5<abc>12true" );
+
+        wire::string grown;
+        for( int i = 0; i < 100000; ++i ) grown.push_back( char( 'a' + i % 26 ) );
+        test3( grown.size(), ==, 100000 );
+        test3( grown.at( 26 ), ==, 'a' );
+    }
+
     test3( wire::string("abc").rstrip(), ==, "abc" );
     test3( wire::string("abc ").rstrip(), ==, "abc" );
     test3( wire::string(" abc").rstrip(), ==, " abc" );
@@ -311,6 +534,819 @@ int main( int argc, const char **argv )
     test3( wire::string(  "true" ).as<double>(), ==, 1.f );
     test3( wire::string(     3.0 ).as<double>(), ==, 3.0 );
 
+    test3( wire::string(  " 42" ).as<int>(), ==, 42 );
+    test3( wire::string(  "+42" ).as<int>(), ==, 42 );
+    test3( wire::string( "-456.123" ).as<long>(), ==, -456 );
+    test3( wire::string( "99999999999" ).as<int>(), ==, 1 );
+    test3( wire::string( "9223372036854775807" ).as<long long>(), ==, 9223372036854775807LL );
+    test3( wire::string( "18446744073709551615" ).as<unsigned long long>(), ==, 18446744073709551615ULL );
+    test3( wire::string( "-2.5e3" ).as<double>(), ==, -2500.0 );
+    test3( wire::string( ".5" ).as<float>(), ==, 0.5f );
+    test3( wire::string( "1e999" ).as<double>(), ==, 1.0 );
+    test3( wire::string( "0.30000000000000004" ).as<double>(), ==, 0.1 + 0.2 );
+
+    {
+        int i = 7; double d = 7; bool b = true; unsigned u = 7;
+        test1( !wire::string( "true" ).try_as( i ) );
+        test3( i, ==, 7 );
+        test1( !wire::string( "" ).try_as( d ) );
+        test1( !wire::string( "2" ).try_as( b ) );
+        test1( !wire::string( "-" ).try_as( u ) );
+        test1( wire::string( "0" ).try_as( b ) );
+        test3( b, ==, false );
+        test1( wire::string( " -12" ).try_as( i ) );
+        test3( i, ==, -12 );
+        test1( wire::string( "1.25" ).try_as( d ) );
+        test3( d, ==, 1.25 );
+    }
+
+    {
+        static const wire::fmt kv( "\1=\2;" );
+        test3( kv( "health", 100 ), ==, "health=100;" );
+        test3( kv( std::string("money"), 123.25f ), ==, "money=123.25;" );
+        test3( kv( 'a' ), ==, "a=\2;" );
+        test3( kv(), ==, "\1=\2;" );
+        test3( wire::fmt( "\2 \1" )( wire::string("world"), false ), ==, "false world" );
+        test3( wire::fmt( "abc \1 \2 \3 \4 \5 \6 \7" )( "hi", 3.14159f, 3.14159L, false, '\x1', (unsigned char)('}'), -1 ), ==, "abc hi 3.14159 3.14159 false \x1 } -1" );
+        test3( wire::string( kv, "zero", 0 ), ==, "zero=0;" );
+
+        std::string out( "a" );
+        kv.append( out, out, out );
+        test3( out, ==, "aa=a;" );
+    }
+
+    {
+        std::string many = "\1\2\3\4\5\6\7" + wire::fmt::slot(8) + wire::fmt::slot(9) + wire::fmt::slot(10) + wire::fmt::slot(3);
+        test3( wire::string( many, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 ), ==, "123456789103" );
+        test3( wire::string( many )( 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 ), ==, "123456789103" );
+        test3( wire::fmt( many )( 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j' ), ==, "abcdefghijc" );
+        test3( wire::string( many, 1, 2 ), ==, "12\3\4\5\6\7" + wire::fmt::slot(8) + wire::fmt::slot(9) + wire::fmt::slot(10) + "\3" );
+        test3( wire::string( "\x10" ), ==, "\x10" );
+        test3( wire::string( "\x10", 1 ), ==, "\x10" );
+
+        std::string twenty;
+        for( unsigned i = 1; i <= 20; ++i ) twenty += wire::fmt::slot(i) + ",";
+        test3( wire::fmt::slot(0), ==, "\1" );
+        test3( wire::fmt::slot(255), ==, "\x10\xff" );
+        test3( wire::fmt::slot(256), ==, wire::fmt::slot(255) );
+        test3( wire::string( twenty, 1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20 ), ==, "1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20," );
+
+        int a1 = 1, a2 = 2, a3 = 3, a4 = 4, a5 = 5, a6 = 6, a7 = 7, a8 = 8, a9 = 9;
+        test3( $wire( "\1=\2,", a1,a2,a3,a4,a5,a6,a7,a8,a9 ), ==, "a1=1,a2=2,a3=3,a4=4,a5=5,a6=6,a7=7,a8=8,a9=9," );
+
+        // call site cache: parsed once, rebuilt only when the site gets another format
+        struct point { int x; } pt = { 7 };
+        auto trace = [&]( const std::string &format, int id ) { return $wire( format, id, pt.x ); };
+        test3( trace( "\1=\2;", 1 ), ==, "id=1;x=7;" );
+        size_t cached = allocations;
+        test3( trace( "\1=\2;", 2 ) == "id=2;x=7;" && allocations == cached, ==, true );
+        test3( trace( "[\1:\2]", 3 ), ==, "[id:3][x:7]" );
+        test3( trace( "\1=\2;", 4 ), ==, "id=4;x=7;" );
+
+        wire::string inplace( "\1 and \2" );
+        inplace.reserve( 64 );
+        const char *before = inplace.data();
+        inplace( "this", "that" );
+        test3( inplace, ==, "this and that" );
+        test1( inplace.data() == before );
+        test3( wire::string( "<\1>" )( wire::string( "<\1>" ) ), ==, "<<\1>>" );
+
+        wire::string large( std::string( 300, '.' ) + "\1" );
+        test3( large( 42 ), ==, std::string( 300, '.' ) + "42" );
+    }
+
+    {
+        wire::string header( "  Content-Length : 1234 ;q=1 " );
+        wire::string_view v = header.view();
+        test3( v.strip(), ==, "Content-Length : 1234 ;q=1" );
+        test3( v.left_of( ":" ).strip(), ==, "Content-Length" );
+        test3( v.right_of( ":" ).left_of( ";" ).strip().as<int>(), ==, 1234 );
+        test3( v.right_of( ";" ).strip().starts_with( "q=" ), ==, true );
+        test3( v.strip().ends_with( "q=1" ), ==, true );
+        test3( v.strip().matches( "Content-*:*;q=?" ), ==, true );
+        test3( v.strip().matches( "Content?Length*" ), ==, true );
+        test3( v.strip( " C" ).at( 0 ), ==, 'o' );
+        test3( v.strip().at( -1 ), ==, '1' );
+        test3( wire::string_view().at( 3 ), ==, '\0' );
+        test3( wire::string_view( "Hi!" ).at( 5 ), ==, '!' );
+        test3( wire::string_view( "Hi!" ).at( -6 ), ==, 'H' );
+        test3( wire::string_view( "hellohello" ).count( "he" ), ==, 2 );
+        test3( wire::string_view( "hello" ).substr( 1, 3 ), ==, "ell" );
+        test3( wire::string_view( "hello" ).substr( 9 ), ==, "" );
+        test3( wire::string_view( "hello" ).find( "lo" ), ==, 3 );
+        test3( wire::string_view( "hello" ).find( "lox" ), ==, wire::string_view::npos );
+        test3( wire::string_view( "hello" ).str( "<", ">" ), ==, "<hello>" );
+
+        std::deque< wire::string_view > tokens = wire::string_view( ",a,,bc,d," ).tokenize( "," );
+        test3( tokens.size(), ==, 3 );
+        test3( tokens[1], ==, "bc" );
+        std::deque< wire::string_view > splits = wire::string_view( "a_b__c" ).split( "_" );
+        test3( splits.size(), ==, 6 );
+        test3( splits[3], ==, "_" );
+
+        wire::string materialized = v.strip().left_of( " " );
+        test3( materialized, ==, "Content-Length" );
+        test3( materialized, ==, v.strip().left_of( " " ) );
+        test3( wire::string( "\1!", v.strip().left_of( "-" ) ), ==, "Content!" );
+        wire::string_view converted = materialized;
+        test3( converted.size(), ==, materialized.size() );
+        int n = 0;
+        test1( !wire::string_view( "abc" ).try_as( n ) );
+    }
+
+    {
+        std::string ascii;
+        for( int i = 0; i < 256; ++i ) ascii += char(i);
+        ascii += ascii;
+        std::string upper = ascii, lower = ascii;
+        for( size_t i = 0; i < upper.size(); ++i ) {
+            if( upper[i] >= 'a' && upper[i] <= 'z' ) upper[i] -= 32;
+            if( lower[i] >= 'A' && lower[i] <= 'Z' ) lower[i] += 32;
+        }
+        test1( wire::string( ascii ).uppercase() == upper );
+        test1( wire::string( ascii ).lowercase() == lower );
+        wire::string in_place( "Hello World 123!" );
+        test3( in_place.to_upper(), ==, "HELLO WORLD 123!" );
+        test3( in_place.to_lower(), ==, "hello world 123!" );
+        test3( wire::string().to_upper(), ==, "" );
+
+        test3( wire::string( "Hello.TXT" ).matchesi( "*.txt" ), ==, true );
+        test3( wire::string( "Hello.TXT" ).matchesi( "hel?o.t*" ), ==, true );
+        test3( wire::string( "Hello.TXT" ).matchesi( "*.doc" ), ==, false );
+        test3( wire::string( "Hello" ).starts_withi( "hE" ), ==, true );
+        test3( wire::string( "Hello" ).starts_withi( "hex" ), ==, false );
+        test3( wire::string( "Hello" ).starts_withi( "hello!" ), ==, false );
+        test3( wire::string( "HELLO" ).ends_withi( "lo" ), ==, true );
+        test3( wire::string( "HELLO" ).ends_withi( "l@" ), ==, false );
+        test3( wire::string( "[" ).starts_withi( "{" ), ==, false );
+    }
+
+    {
+        wire::string line( std::string( 4096, 'a' ) );
+        test3( line.matches( "*a*a*a*a*a*a*a*a*b" ), ==, false );
+        test3( line.matches( "*a*a*a*a*a*a*a*a" ), ==, true );
+        test3( wire::string( std::string( 1 << 20, 'x' ) ).matches( "x*?" ), ==, true );
+
+        test3( wire::string( "a.b" ).matches( "a?b" ), ==, false );
+        test3( wire::string( "a.b" ).matches( "a*b" ), ==, true );
+        test3( wire::string( "" ).matches( "*" ), ==, true );
+        test3( wire::string( "" ).matches( "" ), ==, true );
+        test3( wire::string( "a" ).matches( "" ), ==, false );
+
+        const wire::pattern logs( "*err?r*.log" );
+        test3( logs.matches( "my-error-file.log" ), ==, true );
+        test3( logs.matches( "my-err.r-file.log" ), ==, false );
+        test3( logs.matches( "my-error-file.txt" ), ==, false );
+        test3( logs.matchesi( "MY-ERROR.LOG" ), ==, true );
+        test3( wire::string( "errors.log" ).matches( logs ), ==, true );
+        test3( wire::string_view( "a.log" ).matches( logs ), ==, false );
+        test3( wire::pattern( "abc" ).matches( "abc" ), ==, true );
+        test3( wire::pattern( "abc" ).matches( "abcd" ), ==, false );
+        test3( wire::pattern( "ab*ba" ).matches( "aba" ), ==, false );
+        test3( wire::pattern( "ab*ba" ).matches( "abba" ), ==, true );
+        test3( wire::pattern( line + "*" ).matches( line ), ==, true );
+    }
+
+    {
+        std::map< std::string, std::string > html;
+        html[ "&" ] = "&amp;", html[ "<" ] = "&lt;", html[ ">" ] = "&gt;", html[ "<<" ] = "&laquo;", html[ "<<<" ] = "[3]", html[ "" ] = "?";
+        const wire::replacer escape( html );
+        test3( wire::string( "a<b && c>d" ).replace_map( html ), ==, "a&lt;b &amp;&amp; c&gt;d" );
+        test3( wire::string( "<<<<<<<<" ).replace_map( escape ), ==, "[3][3]&laquo;" );
+        test3( wire::string( "<<x<" ).replace_map( escape ), ==, "&laquo;x&lt;" );
+        test3( wire::string( "plain" ).replace_map( escape ), ==, "plain" );
+        test3( wire::string().replace_map( escape ), ==, "" );
+        test3( escape( "<" ), ==, "&lt;" );
+
+        std::map< std::string, std::string > words;
+        words[ "abc" ] = "1", words[ "abd" ] = "2", words[ "b" ] = "3", words[ "abcd" ] = "4";
+        test3( wire::string( "abcabdabcdabab" ).replace_map( words ), ==, "124a3a3" );
+    }
+
+    {
+        const std::string needle = "needle-in-a-haystack";
+        wire::string hay = std::string( 100, 'x' ) + needle + "yy" + needle + std::string( 50, 'x' );
+        test3( hay.count( needle ), ==, 2 );
+        test3( hay.count( needle, wire::search::naive ), ==, 2 );
+        test3( hay.count( "x", wire::search::horspool ), ==, 150 );
+        test3( wire::string( "aaaa" ).count( "aa", wire::search::horspool ), ==, 2 );
+        test3( hay.replace( needle, "N" ), ==, std::string( 100, 'x' ) + "NyyN" + std::string( 50, 'x' ) );
+        test3( hay.replace1( needle, "N", wire::search::naive ), ==, std::string( 100, 'x' ) + "Nyy" + needle + std::string( 50, 'x' ) );
+        test3( wire::string( "a\nb\n" ).replace( "\n", "\r\n" ), ==, "a\r\nb\r\n" );
+        test3( wire::string( "aaa" ).replace( "aa", "b" ), ==, "ba" );
+        test3( wire::string( "abc" ).replace( "", "-" ), ==, "abc" );
+        test3( wire::string( "abc" ).replace1( "x", "-" ), ==, "abc" );
+
+        wire::string s = "%25hello%25%25world%25";
+        test3( s.replace_inplace( "%25", "%2" ), ==, "%2hello%2%2world%2" );
+        test3( s.replace_inplace( "%2", "%5" ), ==, "%5hello%5%5world%5" );
+        test3( s.replace_inplace( "%5", "" ), ==, "helloworld" );
+        test3( s.replace_inplace( "o", "[o]" ), ==, "hell[o]w[o]rld" );
+        test3( s.replace_inplace( "", "x" ), ==, "hell[o]w[o]rld" );
+    }
+
+    {
+        wire::string csv = ";id,,name;;age,";
+        std::string joined;
+        for( wire::string_view field : wire::tokens( csv, ",;" ) ) joined += field.str( "[", "]" );
+        test3( joined, ==, "[id][name][age]" );
+        test3( wire::tokens( csv, ",;" ).size(), ==, 3 );
+        test3( wire::tokens( ",,,", "," ).size(), ==, 0 );
+        test3( csv.tokens( "," ).begin()->size(), ==, 3 );
+        test3( wire::splits( "a+b", "+" ).size(), ==, 3 );
+        test3( *++wire::splits( "a+b", "+" ).begin(), ==, "+" );
+
+        const wire::charset delims( ",;" );
+        test3( delims.has( ';' ), ==, true );
+        test3( delims.has( ' ' ), ==, false );
+        wire::strings fields;
+        test3( wire::tokenize( csv, delims, fields ), ==, 3 );
+        test3( fields[2], ==, "age" );
+        test3( wire::tokenize( "x y", " ", fields ), ==, 2 );
+        test3( fields.size(), ==, 2 );
+        test3( wire::split( "a, b", ", ", fields ), ==, 4 );
+        test3( fields.str( "\1|" ), ==, "a|,| |b|" );
+        test3( csv.tokenize( "," ).size(), ==, 2 );
+        test3( csv.split( ";" ).size(), ==, 5 );
+    }
+
+    {
+        // long enough for the 64-byte SIMD blocks, with members past the ASCII range
+        const std::string run( 150, 'x' ), body = run + "\xff" + run + "," + run;
+        const wire::charset delims( ",\xff" );
+        test3( delims.find( body.data(), body.data() + body.size() ) - body.data(), ==, 150 );
+        test3( delims.find_not( body.data() + 150, body.data() + body.size() ) - body.data(), ==, 151 );
+        test3( delims.count( body.data(), body.data() + body.size() ), ==, 2 );
+        test3( wire::tokens( body, delims ).size(), ==, 3 );
+        test3( wire::splits( body, delims ).size(), ==, 5 );
+        test3( wire::string( run + "," + std::string( 100, ' ' ) ).strip().size(), ==, 151 );
+        test3( wire::string( std::string( 100, ' ' ) + run ).lstrip().size(), ==, 150 );
+        test3( wire::string( "-" + run + std::string( 70, '-' ) ).strip( "-" ), ==, run );
+        test3( wire::string( body ).count( "," ), ==, 1 );
+        test3( wire::string( std::string( 200, ' ' ) ).strip(), ==, "" );
+    }
+
+    {
+        wire::string_table table;
+        test3( table.at( 3 ), ==, "" );
+        test3( wire::tokenize( "id,name;;age", ",;", table ), ==, 3 );
+        test3( table.bytes(), ==, 9 );
+        test3( table[0], ==, "id" );
+        test3( table[-1], ==, "age" );
+        test3( table.at( 4 ), ==, "name" );
+        test3( table.str( "<\1>" ), ==, "<id><name><age>" );
+        table.push_back( table.front() );
+        test3( table.size(), ==, 4 );
+        test3( table.back(), ==, "id" );
+        test3( *( table.begin() + 2 ), ==, "age" );
+        test3( table.end() - table.begin(), ==, 4 );
+        test3( wire::strings( table ).str( "\1 " ), ==, "id name age id " );
+        test3( wire::string_table( wire::strings( "a", "b" ) ).str( "\1", "[", "]" ), ==, "[ab]" );
+        test3( wire::split( "a+b", "+", table ), ==, 3 );
+        test3( table.str( "\1 " ), ==, "a + b " );
+        table.clear();
+        test3( table.empty(), ==, true );
+    }
+
+    // reader: mapped and streamed files, lines and tokens straddling chunk boundaries
+    {
+        const char *path = "wire.reader.test.txt";
+        std::string text = "id,name,age\r\n1, john doe ,42\n\n2,ana,31\nlast line without newline";
+        if( FILE *fp = std::fopen( path, "wb" ) ) {
+            std::fwrite( text.data(), 1, text.size(), fp );
+            std::fclose( fp );
+        }
+
+        for( size_t chunk : { size_t( 1 ), size_t( 5 ), size_t( 1 ) << 20 } ) {
+            FILE *fp = std::fopen( path, "rb" );
+            wire::reader streamed( fp, chunk );
+            wire::strings lines;
+            for( wire::string_view line : streamed.lines() ) lines.push_back( line );
+            test3( streamed.mapped(), ==, false );
+            test3( lines.size(), ==, 5 );
+            test3( lines[0], ==, "id,name,age" );
+            test3( lines[2], ==, "" );
+            test3( lines[4], ==, "last line without newline" );
+            std::fclose( fp );
+        }
+
+        wire::reader in( path );
+        test3( in.good(), ==, true );
+        test3( in.mapped(), ==, bool( WIRE_POSIX ) );
+        wire::string_view line;
+        test3( in.next_line( line ), ==, true );
+        test3( in.next_line( line ), ==, true );
+        test3( line.right_of( "," ).left_of( "," ).strip(), ==, "john doe" );
+        test3( line.right_of( "," ).right_of( "," ).as<int>(), ==, 42 );
+        test3( line.matches( "1,*,42" ), ==, true );
+
+        wire::reader tiny( path, 3 );
+        wire::strings fields;
+        for( wire::string_view field : tiny.tokens( ",\r\n" ) ) fields.push_back( field );
+        test3( fields.size(), ==, 10 );
+        test3( fields[5], ==, "42" );
+        test3( fields[4].strip(), ==, "john doe" );
+        test3( fields.back(), ==, "last line without newline" );
+
+        test3( wire::reader( "wire.reader.missing.txt" ).good(), ==, false );
+        wire::reader missing( "wire.reader.missing.txt" );
+        test3( missing.next_line( line ), ==, false );
+        std::remove( path );
+    }
+
+    // batch operations: same results serially and across a pool, exceptions and nested batches
+    {
+        wire::pool serial( 1 ), workers( 4, 0 );
+        test3( serial.size(), ==, 1 );
+        test3( workers.size(), ==, 4 );
+
+        wire::strings rows;
+        for( unsigned i = 0; i < 10000; ++i ) rows.push_back( wire::string( "row-\1.txt", i ) );
+        wire::strings numbers;
+        for( unsigned i = 0; i < 10000; ++i ) numbers.push_back( wire::string( i % 3 ? "\1" : "-\1", i ) );
+
+        std::vector< int > a, b;
+        test3( numbers.as_all( a, serial ), ==, 10000 );
+        test3( numbers.as_all( b, workers ), ==, 10000 );
+        test3( a == b, ==, true );
+        test3( b[3], ==, -3 );
+        test3( b[9998], ==, 9998 );
+        std::vector< bool > flags;
+        numbers.as_all( flags, workers );
+        test3( flags[0], ==, false );
+        test3( std::count( flags.begin(), flags.end(), true ), ==, 9999 );
+
+        std::vector< bool > even = rows.matches_all( "row-*7.txt", workers );
+        test3( even == rows.matches_all( "row-*7.txt", serial ), ==, true );
+        test3( std::count( even.begin(), even.end(), true ), ==, 1000 );
+
+        wire::strings upper( rows );
+        upper.transform( []( const wire::string &s ) { return s.uppercase(); }, workers );
+        test3( upper[1234], ==, "ROW-1234.TXT" );
+        upper.transform( []( wire::string &s ) { s.pop_back(); }, workers );
+        test3( upper.back(), ==, "ROW-9999.TX" );
+
+        std::map< std::string, std::string > ext;
+        ext[ ".txt" ] = ".csv";
+        ext[ "row-" ] = "r";
+        wire::strings renamed( rows ), expected( rows );
+        renamed.replace_all_map( wire::replacer( ext ), workers );
+        expected.replace_all_map( wire::replacer( ext ), serial );
+        test3( renamed == expected, ==, true );
+        test3( renamed[42], ==, "r42.csv" );
+
+        bool thrown = false;
+        try {
+            wire::strings( rows ).transform( []( wire::string &s ) { if( s == "row-7777.txt" ) throw std::runtime_error( s.c_str() ); }, workers );
+        } catch( const std::runtime_error &e ) {
+            thrown = ( std::string( e.what() ) == "row-7777.txt" );
+        }
+        test3( thrown, ==, true );
+
+        std::atomic< size_t > inner( 0 );
+        workers.for_each( 1000, [&]( size_t begin, size_t end ) {
+            workers.for_each( end - begin, [&]( size_t b, size_t e ) { inner += e - b; } );
+        } );
+        test3( inner.load(), ==, 1000 );
+    }
+
+    // parallel count/replace/tokenize on a single big buffer: same as serial, also across straddling matches
+    {
+        wire::pool workers( 4 );
+        wire::string text;
+        for( unsigned i = 0; text.size() < 3 * 1024 * 1024; ++i ) text << "aaa,b " << ( i % 7 ? "" : "aaaaaaa\n" );
+        const char *targets[] = { "a", "aa", "aaa,b", "b a", "aaaaaaaaaaaaaaaa" };
+        for( const char *target : targets ) {
+            test3( wire::parallel::count( text, target, workers ), ==, text.count( target ) );
+            test3( wire::parallel::replace( text, target, "<>", workers ) == text.replace( target, "<>" ), ==, true );
+            test3( wire::parallel::replace( text, target, "", workers ) == text.replace( target, "" ), ==, true );
+        }
+        test3( wire::parallel::replace( wire::string_view( text ), "", "x", workers ) == text, ==, true );
+        test3( wire::parallel::count( "small aa text", "a", workers ), ==, 3 );
+
+        // self-overlapping targets over long runs, whose period does not divide the chunk size
+        unsigned seed = 7;
+        for( int round = 0; round < 4; ++round ) {
+            wire::string runs;
+            while( runs.size() < 2 * 1024 * 1024 ) runs.append( ( seed = seed * 1103515245u + 12345u ) >> 12 & 0x3ffff, 'a' ).append( 1, "ab"[ round & 1 ] );
+            const char *periodic[] = { "aaa", "aaaaa", "aba" };
+            for( const char *target : periodic ) {
+                test3( wire::parallel::count( runs, target, workers ), ==, runs.count( target ) );
+                test3( wire::parallel::replace( runs, target, "<>", workers ) == runs.replace( target, "<>" ), ==, true );
+            }
+        }
+
+        std::deque< wire::string_view > serial = text.view().tokenize( ", \n" ), parallel = wire::parallel::tokenize( text, ", \n", workers );
+        bool same = serial.size() == parallel.size();
+        for( size_t i = 0; same && i < serial.size(); ++i ) same = serial[i].data() == parallel[i].data() && serial[i].size() == parallel[i].size();
+        test3( same, ==, true );
+        wire::strings fields( wire::strings( std::vector< std::string >( 3, "reused" ) ) );
+        test3( wire::parallel::tokenize( text, "\n", fields, workers ), ==, text.view().tokenize( "\n" ).size() );
+        test3( fields.front(), ==, text.view().tokenize( "\n" ).front() );
+        test3( wire::parallel::tokenize( text, "#", workers ).size(), ==, 1 );
+    }
+
+    // atoms: one entry per text, O(1) compare and hash; byte compares against other string types
+    {
+        wire::atom empty, host( "host" ), again( std::string( "ho" ) + "st" ), agent( wire::string( "user-agent" ) );
+        test3( empty.empty(), ==, true );
+        test3( empty.id(), ==, 0 );
+        test3( empty == wire::atom( "" ), ==, true );
+        test3( host == again, ==, true );
+        test3( host != agent, ==, true );
+        test3( host.id(), ==, again.id() );
+        test3( host.c_str() == again.c_str(), ==, true );
+        test3( host == "host", ==, true );
+        test3( agent.str(), ==, "user-agent" );
+        test3( host < agent, ==, host.id() < agent.id() );
+        test3( host.hash(), ==, std::hash< wire::string >()( wire::string( "host" ) ) );
+        test3( host.hash(), ==, std::hash< wire::string_view >()( "host" ) );
+        test3( wire::string( "host" ).as< wire::atom >() == host, ==, true );
+
+        size_t known = wire::atom::count();
+        std::vector< std::thread > threads;
+        std::vector< unsigned > ids( 4 );
+        for( unsigned t = 0; t < 4; ++t )
+            threads.emplace_back( [&ids, t]{ for( unsigned i = 0; i < 1000; ++i ) ids[t] += wire::atom( wire::string( "metric.\1", i % 100 ) ).id(); } );
+        for( auto &t : threads ) t.join();
+        test3( wire::atom::count(), ==, known + 100 );
+        test3( ids[0] == ids[1] && ids[1] == ids[2] && ids[2] == ids[3], ==, true );
+
+        std::unordered_set< wire::atom > seen;
+        seen.insert( host ), seen.insert( again ), seen.insert( agent );
+        test3( seen.size(), ==, 2 );
+        std::unordered_map< wire::string, int > counts;
+        counts[ "a" ]++, counts[ wire::string( "a" ) ]++, counts[ "b" ]++;
+        test3( counts.size(), ==, 2 );
+        test3( counts[ "a" ], ==, 2 );
+
+        wire::string header( "content-type: application/json; charset=utf-8" );
+        std::string same( header ), other( "content-type" );
+        size_t before = allocations;
+        bool equal = header == same, different = header == other;
+        test3( allocations - before, ==, 0 );
+        test3( equal, ==, true );
+        test3( different, ==, false );
+        test3( wire::string( "1.0" ) == std::string( "1" ), ==, false );
+        test3( wire::string( "1.0" ) == 1, ==, true );
+    }
+
+    // builder: copied and referenced segments, prepends, in-place formatting, one-allocation str()
+    {
+        wire::builder b;
+        test3( b.empty(), ==, true );
+        test3( b.str(), ==, "" );
+        b << "id=" << 42 << ';' << 1.5 << ' ' << true;
+        test3( b.segments().size(), ==, 1 );
+        b.prepend( "<" ).prepend( wire::string( "[" ) );
+        b.format( "\1:\2>", "x", 7 ) << std::endl;
+        test3( b.str(), ==, "[<id=42;1.5 truex:7>\n" );
+        test3( b.size(), ==, b.str().size() );
+
+        std::string body( 1000, 'z' ), head( 100, 'h' );
+        wire::builder r;
+        r.append_ref( body ).prepend_ref( head ).append_ref( "tiny" ).prepend_ref( "-" );
+        test3( r.segments().size(), ==, 4 );
+        test3( r.segments()[1].data() == head.data(), ==, true );
+        test3( r.segments()[2].data() == body.data(), ==, true );
+        test3( r.str() == "-" + head + body + "tiny", ==, true );
+
+        static const wire::fmt kv( "\1=\2;" );
+        wire::builder doc;
+        std::string expected;
+        for( unsigned i = 0; i < 5000; ++i ) {
+            doc.format( kv, "key", i ).append_ref( body );
+            expected += wire::string( "key=\1;", i ) + body;
+        }
+        doc.prepend( "{" ) << "}";
+        expected = "{" + expected + "}";
+        test3( doc.size(), ==, expected.size() );
+        size_t before = allocations;
+        wire::string flat = doc.str();
+        test3( allocations - before, ==, 1 );
+        test3( flat == expected, ==, true );
+
+        std::string tail( "already:" );
+        test3( doc.append_to( tail ).size(), ==, expected.size() + 8 );
+
+        std::ostringstream os;
+        test3( doc.print( os ), ==, expected.size() );
+        test3( os.str() == expected, ==, true );
+
+        FILE *fp = std::tmpfile();
+        if( fp ) {
+            test3( doc.print( fp ), ==, expected.size() );
+            std::fflush( fp );
+#if WIRE_POSIX
+            test3( doc.writev( fileno( fp ) ), ==, expected.size() );
+            std::string back( 2 * expected.size() + 1, '\0' );
+            std::rewind( fp );
+            test3( std::fread( &back[0], 1, back.size(), fp ), ==, 2 * expected.size() );
+            test3( back.compare( 0, 2 * expected.size(), expected + expected ), ==, 0 );
+#endif
+            std::fclose( fp );
+        }
+
+        wire::builder moved( std::move( doc ) );
+        test3( moved.size(), ==, expected.size() );
+        test3( doc.empty(), ==, true );
+        doc << "reused";
+        test3( doc.str(), ==, "reused" );
+        moved.clear();
+        test3( moved.empty(), ==, true );
+        moved << "again" << 1;
+        test3( moved.str(), ==, "again1" );
+        test3( moved.segments().size(), ==, 1 );
+    }
+
+    // small_string: inline up to N chars, heap beyond; read-only API forwarded to a view, wire::string interop
+    {
+        typedef wire::small_string< 32 > token;
+        test3( sizeof( token ) <= 64, ==, true );
+        size_t before = allocations;
+        token id( "user-1234" ), number( 42 ), copy( id ), empty;
+        id << '/' << number << "/x";
+        token moved( std::move( copy ) );
+        bool small = id.is_inline() && moved.is_inline() && number.is_inline();
+        test3( allocations - before, ==, 0 );
+        test3( small, ==, true );
+        test3( id, ==, "user-1234/42/x" );
+        test3( id.c_str(), ==, std::string( "user-1234/42/x" ) );
+        test3( moved, ==, "user-1234" );
+        test3( copy.empty(), ==, true );
+        test3( empty.c_str(), ==, std::string() );
+        test3( number.as< int >() + 1, ==, 43 );
+        test3( id.left_of( "/" ), ==, "user-1234" );
+        test3( id.count( "/" ), ==, 2 );
+        test3( id.matches( "user-*/x" ), ==, true );
+        test3( id.at( -1 ), ==, 'x' );
+        id[ -1 ] = 'y';
+        test3( id.ends_with( "/y" ), ==, true );
+        empty.at( 3 ) = 'x';
+        test3( empty.size(), ==, 0 );
+
+        token longer( id );
+        for( int i = 0; i < 10; ++i ) longer.append( longer.data(), 8 );
+        test3( longer.is_inline(), ==, false );
+        test3( longer.size(), ==, 94 );
+        test3( longer.starts_with( "user-1234/42/yuser-123" ), ==, true );
+        longer.resize( 4 );
+        test3( longer, ==, "user" );
+        test3( longer.capacity() > 32, ==, true );
+        token stolen( std::move( longer ) );
+        test3( stolen.is_inline(), ==, false );
+        test3( longer.is_inline(), ==, true );
+        longer = "back inline";
+        stolen.swap( longer );
+        test3( stolen, ==, "back inline" );
+        test3( longer, ==, "user" );
+        longer.assign( longer.data() + 1, 2 );
+        test3( longer, ==, "se" );
+
+        wire::string wide( "from wire::string" );
+        token narrow( wide );
+        token converted = wire::string( "converted" ).as< token >();
+        wire::string back( narrow );
+        test3( narrow, ==, "from wire::string" );
+        test3( converted, ==, "converted" );
+        test3( back, ==, "from wire::string" );
+        test3( back == narrow, ==, true );
+        test3( wire::string( "size=\1", narrow ), ==, "size=from wire::string" );
+        test3( narrow.wstr().uppercase(), ==, "FROM WIRE::STRING" );
+        test3( wire::small_string< 8 >( narrow ), ==, "from wire::string" );
+        test3( std::hash< token >()( narrow ) == std::hash< wire::string_view >()( wide ), ==, true );
+
+        std::vector< token > fields;
+        test3( wire::tokenize( "alpha,beta,,gamma", ",", fields ), ==, 3 );
+        test3( fields[2], ==, "gamma" );
+        before = allocations;
+        test3( wire::tokenize( "one;two;three", ";", fields ), ==, 3 );
+        test3( allocations - before, ==, 0 );
+        test3( wire::split( "a+b", "+", fields ), ==, 3 );
+        test3( fields[1], ==, "+" );
+
+        // converts to a view, but never binds as one: nothing can repoint its chars through a base reference
+        wire::small_string< 8 > heap( "longer than eight" );
+        wire::string_view view = heap;
+        heap = wire::string_view( "static text" );
+        bool derived = std::is_base_of< wire::string_view, wire::small_string< 8 > >::value;
+        bool binds = std::is_convertible< wire::small_string< 8 > &, wire::string_view & >::value;
+        test3( derived, ==, false );
+        test3( binds, ==, false );
+        test3( view.size(), ==, 17 );
+        test3( heap, ==, "static text" );
+        test3( heap.is_inline(), ==, false );
+    }
+
+#if WIRE_STATS
+    // stats: per-thread counters, split by call site and summed on demand (built with -DWIRE_STATS=1)
+    {
+        wire::stats::reset();
+        {
+            wire::stats::scope here( "test.stats" );
+            wire::string number( 12345 ), csv( "a,b,c" ), wide( std::string( 100, 'x' ) );
+            csv.tokenize( "," );
+            wide.replace( "x", "yy" );
+            wire::string( "\1-\2", 1, 2 );
+            number.as< int >();
+            std::thread( []{ wire::stats::scope there( "test.stats" ); wire::string( 7 ); } ).join();
+        }
+        wire::string outside( 3 );
+
+        wire::stats::totals replaced = wire::stats::total( wire::stats::replace, "test.stats" );
+        test3( replaced.calls, ==, 1 );
+        test3( replaced.copied, ==, 200 );
+        test3( replaced.allocated >= 200, ==, true );
+        test3( wire::stats::total( wire::stats::tokenize, "test.stats" ).copied, ==, 3 );
+        test3( wire::stats::total( wire::stats::as, "test.stats" ).calls, ==, 1 );
+        test3( wire::stats::total( wire::stats::format, "test.stats" ).copied, ==, 3 );
+        test3( wire::stats::total( wire::stats::construct, "test.stats" ).calls, ==, 2 );
+        test3( wire::stats::total( wire::stats::construct ).calls >= 3, ==, true );
+#if WIRE_STATS_TICKS
+        test3( replaced.ticks > 0, ==, true );
+#endif
+        wire::string report = wire::stats::report().str( "\1\n" );
+        test3( report.count( "test.stats replace: calls=1 allocated=" ), ==, 1 );
+        test3( report.count( " copied=200 " ), ==, 1 );
+        wire::stats::reset();
+        test3( wire::stats::total( wire::stats::replace ).calls, ==, 0 );
+    }
+#endif
+
+    // join engine: one reserve for the whole output, streaming variants
+    {
+        wire::strings words;
+        for( unsigned i = 0; i < 1000; ++i ) words.push_back( wire::string( "word-number-\1", i ) );
+        std::string expected( "{" );
+        for( const wire::string &w : words ) expected += w + ", ";
+        expected += "}";
+        size_t before = allocations;
+        std::string joined = words.str( "\1, ", "{", "}" );
+        test3( allocations - before, <=, 3 );
+        test3( joined == expected, ==, true );
+
+        std::ostringstream os;
+        test3( words.print( os, "\1, ", "{", "}" ), ==, expected.size() );
+        test3( os.str() == expected, ==, true );
+        std::ostringstream whole;
+        whole << words;
+        test3( whole.str() == words.str(), ==, true );
+
+        test3( wire::strings( std::vector< std::string >( 1, "solo" ) ).str( "<\1>", "[", "]" ), ==, "[solo]" );
+        test3( wire::strings().str( "<\1>", "[", "]" ), ==, "[]" );
+
+        std::map< std::string, int > ages;
+        ages[ "ana" ] = 31, ages[ "bob" ] = 7;
+        test3( wire::str( words.size() ? std::vector< int >( 3, 1 ) : std::vector< int >(), "\1;" ), ==, "1;1;1;" );
+        test3( wire::str1( ages, "\1 " ), ==, "ana bob " );
+        test3( wire::str2( ages, "\1 ", "(", ")" ), ==, "(31 7 )" );
+        test3( wire::str12( ages, "\1=\2\3;" ), ==, "ana=31\3;bob=7\3;" );
+
+        FILE *fp = std::tmpfile();
+        if( fp ) {
+            test3( wire::print12( fp, ages, "\1=\2;", "<", ">" ), ==, 15 );
+            std::rewind( fp );
+            char back[ 32 ] = {};
+            test3( std::fread( back, 1, sizeof( back ), fp ), ==, 15 );
+            test3( std::string( back ), ==, "<ana=31;bob=7;>" );
+            std::fclose( fp );
+        }
+
+        std::ostringstream big;
+        wire::strings many( std::vector< std::string >( 20000, "0123456789" ) );
+        test3( many.print( big, "\1\n" ), ==, 220000 );
+        test3( big.str() == many.str(), ==, true );
+    }
+
+    {
+        wire::arena pool;
+        const wire::arena_allocator< char > alloc( pool );
+        wire::arena_string text( "  Hello, arena world; hello  ", alloc );
+        test3( text.strip().get_allocator() == alloc, ==, true );
+        test3( text.strip(), ==, "Hello, arena world; hello" );
+        test3( text.uppercase().get_allocator() == alloc, ==, true );
+        test3( text.replace( "hello", "bye" ), ==, "  Hello, arena world; bye  " );
+        test3( text.replace( "hello", "bye" ).get_allocator() == alloc, ==, true );
+        test3( text.replace( "nope", "bye" ).get_allocator() == alloc, ==, true );
+        test3( text.left_of( "," ).get_allocator() == alloc, ==, true );
+        test3( text.tokenize( " ,;" ).size(), ==, 4 );
+        test3( text.tokenize( " ,;" ).back().get_allocator() == alloc, ==, true );
+        test3( text.tokenize( " ,;" ).get_allocator() == alloc, ==, true );
+        test3( text.split( "," )[1], ==, "," );
+        test3( wire::arena_string( "\1=\2", "x", 42 ), ==, "x=42" );
+        test3( wire::string( text.strip() ), ==, "Hello, arena world; hello" );
+        test3( wire::arena_string( wire::string( "std" ) ), ==, "std" );
+        test3( text.count( "l" ), ==, 5 );
+        test3( text.starts_with( "  H" ), ==, true );
+        test3( wire::string( "\1!", text.strip() ), ==, "Hello, arena world; hello!" );
+        test3( wire::string( text.strip() ).as<int>(), ==, 1 );
+
+        char stack[ 64 ];
+        wire::arena local( stack, sizeof( stack ) );
+        void *first = local.allocate( 16 );
+        test3( first >= (void *)stack && first < (void *)( stack + sizeof( stack ) ), ==, true );
+        test3( local.allocate( 1000 ) != 0, ==, true );
+        local.release();
+        test3( local.allocate( 16 ) == first, ==, true );
+    }
+#if WIRE_PMR
+    {
+        std::pmr::monotonic_buffer_resource pool;
+        wire::pmr::string text( "a,b,,c", &pool );
+        test3( text.tokenize( "," ).size(), ==, 3 );
+        test3( text.tokenize( "," ).front().get_allocator().resource() == &pool, ==, true );
+        test3( text.replace( ",", ";" ).get_allocator().resource() == &pool, ==, true );
+        test3( text.replace( ",", ";" ), ==, "a;b;;c" );
+        test3( text.to_upper(), ==, "A,B,,C" );
+    }
+#endif
+
+    // moves and rvalue overloads reuse buffers: no extra allocations
+    {
+        const char *lorem = "lorem ipsum dolor sit amet, consectetur";
+        std::string big( lorem );
+        const char *buffer = big.data();
+        size_t before = allocations;
+        wire::string moved( std::move( big ) );
+        test3( allocations - before, ==, 0 );
+        test3( moved.data() == buffer, ==, true );
+
+        std::string other( lorem );
+        buffer = other.data();
+        before = allocations;
+        moved = std::move( other );
+        test3( allocations - before, ==, 0 );
+        test3( moved.data() == buffer, ==, true );
+
+        before = allocations;
+        moved = "consectetur adipiscing elit, sed do";
+        moved = 1234567;
+        moved << "consectetur adipiscing elit" << ' ' << 3.5;
+        test3( allocations - before, ==, 0 );
+        test3( moved, ==, "1234567consectetur adipiscing elit 3.5" );
+
+        wire::string tail( lorem ), head;
+        buffer = tail.data();
+        before = allocations;
+        head << std::move( tail );
+        test3( allocations - before, ==, 0 );
+        test3( head.data() == buffer, ==, true );
+
+        wire::string roomy( lorem ), small( "[" );
+        roomy.reserve( 100 );
+        buffer = roomy.data();
+        before = allocations;
+        small += std::move( roomy );
+        test3( allocations - before, ==, 0 );
+        test3( small.data() == buffer, ==, true );
+        test3( small, ==, std::string( "[" ) + lorem );
+
+        wire::string text( "  lorem ipsum dolor sit amet  " );
+        buffer = text.data();
+        before = allocations;
+        wire::string result = std::move( text ).replace( "o", "0" ).replace1( "ipsum", "IPSUM" ).strip().uppercase();
+        test3( allocations - before, ==, 0 );
+        test3( result.data() == buffer, ==, true );
+        test3( result, ==, "L0REM IPSUM D0L0R SIT AMET" );
+
+        wire::string format( "\1 ipsum dolor sit amet, consectetur" );
+        format( "l" );
+        before = allocations;
+        wire::string formatted = wire::string( "\1 ipsum dolor sit amet, consectetur" )( "L" );
+        test3( allocations - before, ==, 1 );
+        test3( formatted, ==, "L ipsum dolor sit amet, consectetur" );
+
+        wire::string line;
+        before = allocations;
+        line.reserve_hint( 64 ) << "id=" << 42 << " ts=" << 1234567.25 << " ratio=" << 0.1f << std::endl;
+        test3( allocations - before, ==, 1 );
+        test3( line, ==, "id=42 ts=1234567.25 ratio=0.1\n" );
+        test3( line.reserve_hint( 1 ).capacity() >= 64, ==, true );
+        const ctest_point p34 = { 3, 4 }, p10 = { 10, 11 };
+        const ctest_hex ff = { 255 };
+        const ctest_nested n12 = { { 1, 2 } };
+        test3( wire::string() << p34 << ' ' << p10, ==, "3,4 10,11" );
+        test3( wire::string() << ff << p10, ==, "ff10,11" );
+        test3( wire::string() << n12 << n12, ==, "(1,2)(1,2)" );
+        test3( wire::string( 0.5 ), ==, "0.5" );
+        test3( wire::string( -0.0 ), ==, "-0" );
+        test3( wire::string( 1e-5 ), ==, "1e-05" );
+        test3( wire::string( 0.0001 ), ==, "0.0001" );
+        test3( wire::string( 123456789012345.0 ), ==, "123456789012345" );
+        test3( wire::string( 1e15 ), ==, "1e+15" );
+        test3( wire::string( 0.1 + 0.2 ), ==, "0.30000000000000004" );
+        test3( wire::string( 1234567.f ), ==, "1234567" );
+
+        wire::string self( "ab" );
+        self << self;
+        test3( self, ==, "abab" );
+        self = self.view().substr( 1, 2 );
+        test3( self, ==, "ba" );
+        test3( wire::string( "  x  " ).strip( " x" ), ==, "" );
+        test3( wire::string( "xxab" ).lstrip( "x" ), ==, "ab" );
+        test3( wire::string( "abxx" ).rtrim( "x" ), ==, "ab" );
+    }
+
     //del replacement
     test3( wire::string("%25hello%25%25world%25").replace("%25",""), ==, "helloworld" );
     //same replacement
@@ -354,6 +1390,17 @@ int main( int argc, const char **argv )
     test3( wire::string().at(-1), ==, '\0' );
     test3( wire::string().at( 0), ==, '\0' );
     test3( wire::string().at( 1), ==, '\0' );
+    {
+        wire::string empty;
+        empty.at( 3 ) = 'x';
+        test3( empty.at( 3 ), ==, '\0' );
+        test3( empty.size(), ==, 0 );
+
+        wire::strings none;
+        none.at( 0 ) = "garbage";
+        test3( none.at( -1 ), ==, "" );
+        test3( none.size(), ==, 0 );
+    }
 
     // Other tests
     tests_from_string_sample();
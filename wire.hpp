@@ -1,885 +1,5050 @@
-/* Extended C++ standard string classes, string interpolation and casting macros.
- * Copyright (c) 2010-2014, Mario 'rlyeh' Rodriguez, zlib/libpng licensed.
-
- * wire::format() based on code by Adam Rosenfield (see http://goo.gl/XPnoe)
- * wire::format() based on code by Tom Distler (see http://goo.gl/KPT66)
-
- * @todo:
- * - string::replace_map(): specialize for target_t == char || replacement_t == char
- * - string::replace_map(): specialize for (typename<size_t N> const char (&from)[N], const char (&to)[N])
- * - strings::subset( 0, EOF )
- * - strings::subset( N, EOF )
- * - strings::subset( 0, -1 ) -> 0, EOF - 1
- * - strings::subset( -2, -1 ) -> EOF-2, EOF-1
-
- * - rlyeh
- */
-
-#pragma once
-
-#include <cctype>
-#include <cstdarg>
-#include <cstdio>
-#include <cstring>
-
-#include <algorithm>
-#include <deque>
-#include <iomanip>
-#include <iostream>
-#include <limits>
-#include <map>
-#include <sstream>
-#include <string>
-#include <vector>
-
-#define WIRE_VERSION "2.2.0" /* (2016/04/18) - Moved getopt to a library apart.
-#define WIRE_VERSION "2.1.0" // (2015/09/19) - Moved .ini reader/writer to a library apart.
-#define WIRE_VERSION "2.0.0" // (2015/08/09) - Moved string interpolator to a library apart; Improved INI reader;
-#define WIRE_VERSION "1.0.0" // (2015/06/12) - Removed a few warnings
-#define WIRE_VERSION "0.0.0" // (2010/xx/xx) - Initial commit */
-
-#ifdef _MSC_VER
-#    define wire$vsnprintf _vsnprintf
-#    pragma warning( push )
-#    pragma warning( disable : 4996 )
-#else
-#    define wire$vsnprintf  vsnprintf
-#endif
-
-namespace wire
-{
-    /* Public API */
-    // Function tools
-
-    // Function to do safe C-style formatting
-    static inline std::string format( const char *fmt, ... ) {
-        int len;
-        std::string self;
-        using namespace std;
-
-        // Calculate the final length of the formatted string
-        {
-            va_list args;
-            va_start( args, fmt );
-            len = wire$vsnprintf( 0, 0, fmt, args );
-            va_end( args );
-        }
-
-        // Allocate a buffer (including room for null termination)
-        char* target_string = new char[++len];
-
-        // Generate the formatted string
-        {
-            va_list args;
-            va_start( args, fmt );
-            wire$vsnprintf( target_string, len, fmt, args );
-            va_end( args );
-        }
-
-        // Assign the formatted string
-        self.assign( target_string );
-
-        // Clean up
-        delete [] target_string;
-        return self;
-    }
-
-    // Function to convert strings <-> numbers in most precise way (C99)
-    static inline std::string precise( const long double &t ) {
-        /**/ if( t ==  std::numeric_limits< long double >::infinity() ) return  "INF";
-        else if( t == -std::numeric_limits< long double >::infinity() ) return "-INF";
-        else if( t != t ) return "NaN";
-        // C99 way {
-        char buf[ 32 ];
-        sprintf(buf, "%La", t);
-        return buf;
-        // }
-    }
-    static inline long double precise( const std::string &t ) {
-        long double ld;
-        sscanf(t.c_str(), "%La", &ld);
-        return ld;
-    }
-
-    /* Public API */
-    // Main class
-
-    namespace
-    {
-        template< typename T >
-        inline T as( const std::string &self ) {
-            T t;
-            if( std::istringstream(self) >> t )
-                return t;
-            bool is_true = self.size() && (self != "0") && (self != "false");
-            return (T)(is_true);
-        }
-
-        template<>
-        inline char as( const std::string &self ) {
-            return self.size() == 1 ? (char)(self[0]) : (char)(as<int>(self));
-        }
-        template<>
-        inline signed char as( const std::string &self ) {
-            return self.size() == 1 ? (signed char)(self[0]) : (signed char)(as<int>(self));
-        }
-        template<>
-        inline unsigned char as( const std::string &self ) {
-            return self.size() == 1 ? (unsigned char)(self[0]) : (unsigned char)(as<int>(self));
-        }
-
-        template<>
-        inline const char *as( const std::string &self ) {
-            return self.c_str();
-        }
-        template<>
-        inline std::string as( const std::string &self ) {
-            return self;
-        }
-    }
-
-    class string : public std::string
-    {
-        public:
-
-        // basic constructors
-
-        string() : std::string()
-        {}
-
-/*
-        string( const string &x ) : std::string()
-        {
-            this->assign( x );
-        }
-        string &operator=( const string &other ){
-            if( this != &other ) {
-            }
-            return *this;
-        }
-
-        string( string &&x ) : std::string{std::forward<std::string>(x)}
-        {}
-        string &operator=( string &&other ){
-            if( this != &other ) {
-            }
-            return *this;
-        }
-*/
-
-        /*
-        string( string &&other ) : std::string()
-        {
-            *this = std::move(other);
-        }
-        */
-
-        string( const std::string &s ) : std::string( s )
-        {}
-
-        string( const char &c ) : std::string( 1, c )
-        {}
-
-        string( const char &c, size_t n ) : std::string( n, c )
-        {}
-
-        string( size_t n, const char &c ) : std::string( n, c )
-        {}
-
-        string( const char *cstr ) : std::string( cstr ? cstr : "" )
-        {}
-
-        string( char * const &cstr ) : std::string( cstr ? cstr : "" )
-        {}
-
-        template<size_t N>
-        string( const char (&cstr)[N] ) : std::string( cstr )
-        {}
-
-        string( const bool &val ) : std::string( val ? "true" : "false" )
-        {}
-
-        // constructor sugars
-
-        template< typename T >
-        string( const T &t ) : std::string()
-        {
-            std::stringstream ss;
-            if( ss << /* std::boolalpha << */ t )
-                this->assign( ss.str() );
-        }
-
-        string( const float &t ) : std::string()
-        {
-            *this = string( (long double)t );
-        }
-
-        string( const double &t ) : std::string()
-        {
-            *this = string( (long double)t );
-        }
-
-        string( const long double &t ) : std::string()
-        {
-            // enum { max_digits = std::numeric_limits<long double>::digits10 + 2 };
-            std::stringstream ss;
-            if( ss << (long double)(t) )
-                this->assign( ss.str() );
-        }
-
-        // extended constructors; safe formatting
-
-        private:
-        template<unsigned N>
-        std::string &formatsafe( const std::string &fmt, std::string (&t)[N] )
-        {
-            for( const unsigned char &ch : fmt ) {
-                if( ch > N ) t[0] += char(ch);
-                else t[0] += t[ ch ];
-            }
-            return t[0];
-        }
-        public:
-
-        template< typename T1 >
-        string( const std::string &fmt, const T1 &t1 ) : std::string()
-        {
-            std::string t[] = { std::string(), string(t1) };
-            assign( formatsafe( fmt, t ) );
-        }
-
-        template< typename T1, typename T2 >
-        string( const std::string &fmt, const T1 &t1, const T2 &t2 ) : std::string()
-        {
-            std::string t[] = { std::string(), string(t1), string(t2) };
-            assign( formatsafe( fmt, t ) );
-        }
-
-        template< typename T1, typename T2, typename T3 >
-        string( const std::string &fmt, const T1 &t1, const T2 &t2, const T3 &t3 ) : std::string()
-        {
-            std::string t[] = { std::string(), string(t1), string(t2), string(t3) };
-            assign( formatsafe( fmt, t ) );
-        }
-
-        template< typename T1, typename T2, typename T3, typename T4 >
-        string( const std::string &fmt, const T1 &t1, const T2 &t2, const T3 &t3, const T4 &t4 ) : std::string()
-        {
-            std::string t[] = { std::string(), string(t1), string(t2), string(t3), string(t4) };
-            assign( formatsafe( fmt, t ) );
-        }
-
-        template< typename T1, typename T2, typename T3, typename T4, typename T5 >
-        string( const std::string &fmt, const T1 &t1, const T2 &t2, const T3 &t3, const T4 &t4, const T5 &t5 ) : std::string()
-        {
-            std::string t[] = { std::string(), string(t1), string(t2), string(t3), string(t4), string(t5) };
-            assign( formatsafe( fmt, t ) );
-        }
-
-        template< typename T1, typename T2, typename T3, typename T4, typename T5, typename T6 >
-        string( const std::string &fmt, const T1 &t1, const T2 &t2, const T3 &t3, const T4 &t4, const T5 &t5, const T6 &t6 ) : std::string()
-        {
-            std::string t[] = { std::string(), string(t1), string(t2), string(t3), string(t4), string(t5), string(t6) };
-            assign( formatsafe( fmt, t ) );
-        }
-
-        template< typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7 >
-        string( const std::string &fmt, const T1 &t1, const T2 &t2, const T3 &t3, const T4 &t4, const T5 &t5, const T6 &t6, const T7 &t7 ) : std::string()
-        {
-            std::string t[] = { std::string(), string(t1), string(t2), string(t3), string(t4), string(t5), string(t6), string(t7) };
-            assign( formatsafe( fmt, t ) );
-        }
-
-        wire::string &operator()() {
-            return *this;
-        }
-
-        template< typename T1 >
-        wire::string &operator()( const T1 &t1 ) {
-            return assign( string( *this, t1 ) ), *this;
-        }
-
-        template< typename T1, typename T2 >
-        wire::string &operator()( const T1 &t1, const T2 &t2 ) {
-            return assign( string( *this, t1, t2 ) ), *this;
-        }
-
-        template< typename T1, typename T2, typename T3 >
-        wire::string &operator()( const T1 &t1, const T2 &t2, const T3 &t3 ) {
-            return assign( string( *this, t1, t2, t3 ) ), *this;
-        }
-
-        template< typename T1, typename T2, typename T3, typename T4 >
-        wire::string &operator()( const T1 &t1, const T2 &t2, const T3 &t3, const T4 &t4 ) {
-            return assign( string( *this, t1, t2, t3, t4 ) ), *this;
-        }
-
-        template< typename T1, typename T2, typename T3, typename T4, typename T5 >
-        wire::string &operator()( const T1 &t1, const T2 &t2, const T3 &t3, const T4 &t4, const T5 &t5 ) {
-            return assign( string( *this, t1, t2, t3, t4, t5 ) ), *this;
-        }
-
-        template< typename T1, typename T2, typename T3, typename T4, typename T5, typename T6 >
-        wire::string &operator()( const T1 &t1, const T2 &t2, const T3 &t3, const T4 &t4, const T5 &t5, const T6 &t6 ) {
-            return assign( string( *this, t1, t2, t3, t4, t5, t6 ) ), *this;
-        }
-
-        template< typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7 >
-        wire::string &operator()( const T1 &t1, const T2 &t2, const T3 &t3, const T4 &t4, const T5 &t5, const T6 &t6, const T7 &t7 ) {
-            return assign( string( *this, t1, t2, t3, t4, t5, t6, t7 ) ), *this;
-        }
-
-        // conversion
-
-        template< typename T >
-        T as() const
-        {
-            return wire::as<T>(*this);
-        }
-
-        template< typename T >
-        operator T() const
-        {
-            return wire::as<T>(*this);
-        }
-
-        // chaining operators
-
-        template <typename T>
-        string &operator <<( const T &t )
-        {
-            //*this = *this + string(t);
-            this->append( string(t) );
-            return *this;
-        }
-
-        string &operator <<( std::ostream &( *pf )(std::ostream &) )
-        {
-            return *pf == static_cast<std::ostream& ( * )(std::ostream&)>( std::endl ) ? (*this) += "\n", *this : *this;
-        }
-
-        template< typename T >
-        string &operator +=( const T &t )
-        {
-            return operator<<(t);
-        }
-
-        string &operator +=( std::ostream &( *pf )(std::ostream &) )
-        {
-            return operator<<(pf);
-        }
-
-        // assignment sugars
-
-        template< typename T >
-        string &operator=( const T &t )
-        {
-            this->assign( string(t) );
-            return *this;
-        }
-
-        // comparison sugars
-/*
-        operator const bool() const
-        {
-            return wire::as<bool>(*this);
-        }
-*/
-        template<typename T>
-        bool operator ==( const T &t ) const
-        {
-            return wire::as<T>(*this) == wire::string(t).as<T>();
-        }
-        bool operator ==( const wire::string &t ) const
-        {
-            return this->compare( t ) == 0;
-        }
-        bool operator ==( const char *t ) const
-        {
-            return this->compare( t ) == 0;
-        }
-
-        // extra methods
-
-        // at() classic behaviour: "hello"[5] = undefined, "hello"[-1] = undefined
-        // at() extended behaviour: "hello"[5] = h, "hello"[-1] = o,
-
-        const char &at( const int &pos ) const
-        {
-            signed size = (signed)(this->size());
-            if( size )
-                return this->std::string::at( pos >= 0 ? pos % size : size - 1 + ((pos+1) % size) );
-            static std::map< const string *, char > map;
-            return ( ( map[ this ] = map[ this ] ) = '\0' );
-        }
-
-        char &at( const int &pos )
-        {
-            signed size = (signed)(this->size());
-            if( size )
-                return this->std::string::at( pos >= 0 ? pos % size : size - 1 + ((pos+1) % size) );
-            static std::map< const string *, char > map;
-            return ( ( map[ this ] = map[ this ] ) = '\0' );
-        }
-
-        const char &operator[]( const int &pos ) const {
-            return this->at(pos);
-        }
-        char &operator[]( const int &pos ) {
-            return this->at(pos);
-        }
-
-        void pop_back()
-        {
-            if( this->size() )
-                this->erase( this->end() - 1 );
-        }
-
-        void pop_front()
-        {
-            if( this->size() )
-                this->erase( 0, 1 ); //this->substr( 1 ); //this->assign( this->begin() + 1, this->end() );
-        }
-
-        template<typename T>
-        void push_back( const T& t ) {
-            //std::swap( *this, *this + string(t) );
-            *this = *this + string(t);
-        }
-
-        template<typename T>
-        void push_front( const T& t ) {
-            //std::swap( *this, string(t) + *this );
-            *this = string(t) + *this;
-        }
-
-        const char &back() const
-        {
-            return at(-1);
-        }
-
-        char &back()
-        {
-            return at(-1);
-        }
-
-        const char &front() const
-        {
-            return at(0);
-        }
-
-        char &front()
-        {
-            return at(0);
-        }
-
-        // tools
-
-        std::string str( const std::string &pre = std::string(), const std::string &post = std::string() ) const
-        {
-            return pre + *this + post;
-        }
-
-        string uppercase() const
-        {
-            std::string s = *this;
-
-            std::transform( s.begin(), s.end(), s.begin(), (int(*)(int)) std::toupper );
-
-            return s;
-        }
-
-        string lowercase() const
-        {
-            std::string s = *this;
-
-            std::transform( s.begin(), s.end(), s.begin(), (int(*)(int)) std::tolower );
-
-            return s;
-        }
-
-        bool matches( const std::string &pattern ) const
-        {
-            struct local {
-                static bool match( const char *pattern, const char *str ) {
-                    if( *pattern=='\0' ) return !*str;
-                    if( *pattern=='*' )  return match(pattern+1, str) || (*str && match(pattern, str+1));
-                    if( *pattern=='?' )  return *str && (*str != '.') && match(pattern+1, str+1);
-                    return (*str == *pattern) && match(pattern+1, str+1);
-                }
-            };
-
-            return local::match( pattern.c_str(), (*this).c_str() );
-        }
-
-        bool matchesi( const std::string &pattern ) const
-        {
-            return this->uppercase().matches( string(pattern).uppercase() );
-        }
-
-        size_t count( const std::string &substr ) const
-        {
-            size_t n = 0;
-            std::string::size_type pos = 0;
-            while( (pos = this->find( substr, pos )) != std::string::npos ) {
-                n++;
-                pos += substr.size();
-            }
-            return n;
-        }
-
-        string left_of( const std::string &substring ) const
-        {
-            string::size_type pos = this->find( substring );
-            return pos == std::string::npos ? *this : (string)this->substr(0, pos);
-        }
-
-        string right_of( const std::string &substring ) const
-        {
-            std::string::size_type pos = this->find( substring );
-            return pos == std::string::npos ? *this : (string)this->substr(pos + 1);
-        }
-
-        string replace1( const std::string &target, const std::string &replacement ) const {
-            std::string str = *this;
-            auto found = str.find(target);
-            return found == string::npos ? str : (str.replace(found, target.length(), replacement), str);
-        }
-
-        string replace( const std::string &target, const std::string &replacement ) const
-        {
-            size_t found = 0;
-            std::string s = *this;
-
-            while( ( found = s.find( target, found ) ) != string::npos )
-            {
-                s.replace( found, target.length(), replacement );
-                found += replacement.length();
-            }
-
-            return s;
-        }
-
-        string replace_map( const std::map< std::string, std::string > &replacements ) const
-        {
-            string out;
-
-            for( size_t i = 0; i < this->size(); )
-            {
-                bool found = false;
-                size_t match_length = 0;
-
-                std::map< std::string, std::string >::const_reverse_iterator it;
-                for( it = replacements.rbegin(); !found && it != replacements.rend(); ++it )
-                {
-                    const std::string &target = it->first;
-                    const std::string &replacement = it->second;
-
-                    if( match_length != target.size() )
-                        match_length = target.size();
-
-                    if( this->size() - i >= target.size() )
-                    if( !std::memcmp( &this->at(int(i)), &target.at(0), (int)match_length ) )
-                    {
-                        i += target.size();
-
-                        out += replacement;
-
-                        found = true;
-                    }
-                }
-
-                if( !found )
-                    out += this->at(int(i++));
-            }
-
-           return out;
-        }
-
-        private:
-
-        string strip( const std::string &chars, bool strip_left, bool strip_right ) const
-        {
-            std::string::size_type len = this->size(), i = 0, j = len, charslen = chars.size();
-
-            if( charslen == 0 )
-            {
-                if( strip_left )
-                    while( i < len && std::isspace( this->operator[]( int(i) ) ))
-                        i++;
-
-                if( strip_right && j ) {
-                    do j--; while( j >= i && std::isspace( this->operator[]( int(j) ) ));
-                    j++;
-                }
-            }
-            else
-            {
-                const char *sep = chars.c_str();
-
-                if( strip_left )
-                    while( i < len && std::memchr( sep, this->operator[]( int(i) ), charslen ))
-                        i++;
-
-                if( strip_right && j ) {
-                    do j--; while( j >= i && std::memchr( sep, this->operator[]( int(j) ), charslen ));
-                    j++;
-                }
-            }
-
-            if( j - i == len ) return *this;
-            return this->substr( i, j - i );
-        }
-
-        public: // based on python string and pystring
-
-        // Return a copy of the string with leading characters removed (default chars: space)
-        string lstrip( const std::string &chars = std::string() ) const
-        {
-            return strip( chars, true, false );
-        }
-        string ltrim( const std::string &chars = std::string() ) const
-        {
-            return strip( chars, true, false );
-        }
-
-        // Return a copy of the string with trailing characters removed (default chars: space)
-        string rstrip( const std::string &chars = std::string() ) const
-        {
-            return strip( chars, false, true );
-        }
-        string rtrim( const std::string &chars = std::string() ) const
-        {
-            return strip( chars, false, true );
-        }
-
-        // Return a copy of the string with both leading and trailing characters removed (default chars: space)
-        string strip( const std::string &chars = std::string() ) const
-        {
-            return strip( chars, true, true );
-        }
-        string trim( const std::string &chars = std::string() ) const
-        {
-            return strip( chars, true, true );
-        }
-
-        bool starts_with( const std::string &prefix ) const
-        {
-            return this->size() >= prefix.size() ? this->substr( 0, prefix.size() ) == prefix : false;
-        }
-
-        bool starts_withi( const std::string &prefix ) const
-        {
-            return this->uppercase().starts_with( string(prefix).uppercase() );
-        }
-
-        bool ends_with( const std::string &suffix ) const
-        {
-            return this->size() < suffix.size() ? false : this->substr( this->size() - suffix.size() ) == suffix;
-        }
-
-        bool ends_withi( const std::string &suffix ) const
-        {
-            return this->uppercase().ends_with( string(suffix).uppercase() );
-        }
-
-        std::deque< string > tokenize( const std::string &delimiters ) const {
-            std::string map( 256, '\0' );
-            for( const unsigned char &ch : delimiters )
-                map[ ch ] = '\1';
-            std::deque< string > tokens(1);
-            for( const unsigned char &ch : *this ) {
-                /**/ if( !map.at(ch)          ) tokens.back().push_back( char(ch) );
-                else if( tokens.back().size() ) tokens.push_back( string() );
-            }
-            while( tokens.size() && !tokens.back().size() ) tokens.pop_back();
-            return tokens;
-        }
-
-        // tokenize_incl_separators
-        std::deque< string > split( const std::string &delimiters ) const {
-            std::string str;
-            std::deque< string > tokens;
-            for( auto &ch : *this ) {
-                if( delimiters.find_first_of( ch ) != std::string::npos ) {
-                    if( str.size() ) tokens.push_back( str ), str = "";
-                    tokens.push_back( std::string() + ch );
-                } else str += ch;
-            }
-            return str.empty() ? tokens : ( tokens.push_back( str ), tokens );
-        }
-    };
-
-    class strings : public std::deque< string >
-    {
-        public:
-
-        strings() : std::deque< string >()
-        {}
-
-        strings( const int &argc, const char **&argv ) : std::deque< string >()
-        {
-            for( int i = 0; i < argc; ++i )
-                this->push_back( argv[i] );
-        }
-
-        strings( const int &argc, char **&argv ) : std::deque< string >()
-        {
-            for( int i = 0; i < argc; ++i )
-                this->push_back( argv[i] );
-        }
-
-        template< typename T, const size_t N >
-        strings( const T (&args)[N] ) : std::deque< string >()
-        {
-            this->resize( N );
-            for( int n = 0; n < N; ++n )
-                (*this)[ n ] = args[ n ];
-        }
-
-        template <typename CONTAINER>
-        strings( const CONTAINER &other ) : std::deque< string >( other.begin(), other.end() )
-        {}
-
-        template <typename CONTAINER>
-        strings &operator =( const CONTAINER &other ) {
-            if( &other != this ) {
-                *this = strings( other );
-            }
-            return *this;
-        }
-
-        template< typename T > strings( const T &t0, const T &t1 ) : std::deque< string >()
-        { this->resize(2); (*this)[0] = t0; (*this)[1] = t1; }
-        template< typename T > strings( const T &t0, const T &t1, const T &t2 ) : std::deque< string >()
-        { this->resize(3); (*this)[0] = t0; (*this)[1] = t1; (*this)[2] = t2; }
-        template< typename T > strings( const T &t0, const T &t1, const T &t2, const T &t3 ) : std::deque< string >()
-        { this->resize(4); (*this)[0] = t0; (*this)[1] = t1; (*this)[2] = t2; (*this)[3] = t3; }
-        template< typename T > strings( const T &t0, const T &t1, const T &t2, const T &t3, const T &t4 ) : std::deque< string >()
-        { this->resize(5); (*this)[0] = t0; (*this)[1] = t1; (*this)[2] = t2; (*this)[3] = t3; (*this)[4] = t4; }
-        template< typename T > strings( const T &t0, const T &t1, const T &t2, const T &t3, const T &t4, const T &t5 ) : std::deque< string >()
-        { this->resize(6); (*this)[0] = t0; (*this)[1] = t1; (*this)[2] = t2; (*this)[3] = t3; (*this)[4] = t4; (*this)[5] = t5; }
-        template< typename T > strings( const T &t0, const T &t1, const T &t2, const T &t3, const T &t4, const T &t5, const T &t6 ) : std::deque< string >()
-        { this->resize(7); (*this)[0] = t0; (*this)[1] = t1; (*this)[2] = t2; (*this)[3] = t3; (*this)[4] = t4; (*this)[5] = t5; (*this)[6] = t6; }
-
-        const string &at( const int &pos ) const
-        {
-            signed size = signed(this->size());
-            if( size )
-                return *( this->begin() + ( pos >= 0 ? pos % size : size - 1 + ((pos+1) % size) ) );
-            static std::map< const strings *, string > map;
-            return ( ( map[ this ] = map[ this ] ) = string() );
-        }
-
-        string &at( const int &pos )
-        {
-            signed size = signed(this->size());
-            if( size )
-                return *( this->begin() + ( pos >= 0 ? pos % size : size - 1 + ((pos+1) % size) ) );
-            static std::map< const strings *, string > map;
-            return ( ( map[ this ] = map[ this ] ) = string() );
-        }
-
-        const string &operator[]( const int &pos ) const {
-            return at(pos);
-        }
-        string &operator[]( const int &pos ) {
-            return at(pos);
-        }
-
-        std::string str( const char *format1 = "\1\n", const std::string &pre = std::string(), const std::string &post = std::string() ) const
-        {
-            if( this->size() == 1 )
-                return pre + *this->begin() + post;
-
-            std::string out( pre );
-
-            for( const_iterator it = this->begin(); it != this->end(); ++it )
-                out += string( format1, (*it) );
-
-            return out + post;
-        }
-
-        inline friend std::ostream &operator <<( std::ostream &os, const wire::strings &self ) {
-            return os << self.str(), os;
-        }
-    };
-}
-
-// Generic print containers
-
-namespace wire
-{
-    template<typename T>
-    inline std::string str( const T& t, const std::string &format1, const std::string &pre = std::string(), const std::string &post = std::string() )
-    {
-        wire::string out;
-
-        for( typename T::const_iterator it = t.begin(), end = t.end(); it != end; ++it )
-            out << wire::string( format1, *it );
-
-        return wire::string() << pre << out << post;
-    }
-
-    template<typename T>
-    inline std::string str1( const T& t, const std::string &format1, const std::string &pre = std::string(), const std::string &post = std::string() )
-    {
-        wire::string out;
-
-        for( typename T::const_iterator it = t.begin(), end = t.end(); it != end; ++it )
-            out << wire::string( format1, it->first );
-
-        return wire::string() << pre << out << post;
-    }
-
-    template<typename T>
-    inline std::string str2( const T& t, const std::string &format1, const std::string &pre = std::string(), const std::string &post = std::string() )
-    {
-        wire::string out;
-
-        for( typename T::const_iterator it = t.begin(), end = t.end(); it != end; ++it )
-            out << wire::string( format1, it->second );
-
-        return wire::string() << pre << out << post;
-    }
-
-    template<typename T>
-    inline std::string str12( const T& t, const std::string &format12, const std::string &pre = std::string(), const std::string &post = std::string() )
-    {
-        wire::string out;
-
-        for( typename T::const_iterator it = t.begin(), end = t.end(); it != end; ++it )
-            out << wire::string( format12, it->first, it->second );
-
-        return wire::string() << pre << out << post;
-    }
-}
-
-// $wire(), introspective macro
-
-namespace wire
-{
-    // @todo: eq+sep+line is a c++11 constexpr
-    struct parser : public wire::string {
-        parser( const wire::string &fmt, const wire::string &line = std::string() ) {
-            wire::strings all = line.tokenize(", \r\n\t");
-            wire::strings::iterator it, begin, end;
-
-            typedef std::pair<std::string,std::string> pair;
-            std::vector< pair > results;
-
-            for( it = begin = all.begin(), end = all.end(); it != end; ++it ) {
-                results.push_back( pair( (*it).right_of(".").right_of("->"), std::string() + char(it - begin + '\1') ) );
-            }
-
-            assign( str12(results, fmt) );
-        }
-    };
-}
-
-#define $wire(FMT,...) wire::parser(FMT,#__VA_ARGS__)(__VA_ARGS__)
-
-#ifdef _MSC_VER
-#    pragma warning( pop )
-#endif
-#undef wire$vsnprintf
+/* Extended C++ standard string classes, string interpolation and casting macros.
+ * Copyright (c) 2010-2014, Mario 'rlyeh' Rodriguez, zlib/libpng licensed.
+
+ * wire::format() based on code by Adam Rosenfield (see http://goo.gl/XPnoe)
+ * wire::format() based on code by Tom Distler (see http://goo.gl/KPT66)
+
+ * @todo:
+ * - string::replace_map(): specialize for (typename<size_t N> const char (&from)[N], const char (&to)[N])
+ * - strings::subset( 0, EOF )
+ * - strings::subset( N, EOF )
+ * - strings::subset( 0, -1 ) -> 0, EOF - 1
+ * - strings::subset( -2, -1 ) -> EOF-2, EOF-1
+
+ * - rlyeh
+ */
+
+#pragma once
+
+#include <cctype>
+#include <cerrno>
+#include <clocale>
+#include <cmath>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__AVX2__)
+#   include <immintrin.h>
+#   define WIRE_AVX2 1
+#   define WIRE_AVX2_TARGET
+#elif ( defined(__x86_64__) || defined(__i386__) ) && ( defined(__clang__) || __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ) )
+#   include <immintrin.h>
+#   define WIRE_AVX2 2 /* picked at runtime */
+#   define WIRE_AVX2_TARGET __attribute__(( target( "avx2" ) ))
+#endif
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+// WIRE_PMR is defined when wire::pmr::string (std::pmr-backed wire string) is available
+#if __cplusplus >= 201703L && defined(__has_include)
+#   if __has_include(<memory_resource>)
+#       include <memory_resource>
+#       define WIRE_PMR 1
+#   endif
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#   include <emmintrin.h>
+#   define WIRE_SSE2 1
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   include <arm_neon.h>
+#   define WIRE_NEON 1
+#endif
+
+// Define WIRE_POSIX to 1 for wire::reader to memory-map files and for wire::builder::writev() (POSIX only;
+// the reader streams files otherwise). Off by default, so that <fcntl.h>, <sys/mman.h>, <sys/stat.h>,
+// <sys/uio.h> and <unistd.h> (and their unqualified read(), write(), close()...) only reach the translation
+// units that ask for them.
+#ifndef WIRE_POSIX
+#    define WIRE_POSIX 0
+#endif
+#if WIRE_POSIX && !( defined(__unix__) || defined(__APPLE__) )
+#    undef WIRE_POSIX
+#    define WIRE_POSIX 0
+#endif
+#if WIRE_POSIX
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <sys/uio.h>
+#   include <unistd.h>
+#endif
+
+#define WIRE_VERSION "2.2.0" /* (2016/04/18) - Moved getopt to a library apart.
+#define WIRE_VERSION "2.1.0" // (2015/09/19) - Moved .ini reader/writer to a library apart.
+#define WIRE_VERSION "2.0.0" // (2015/08/09) - Moved string interpolator to a library apart; Improved INI reader;
+#define WIRE_VERSION "1.0.0" // (2015/06/12) - Removed a few warnings
+#define WIRE_VERSION "0.0.0" // (2010/xx/xx) - Initial commit */
+
+// Define WIRE_COMPAT_PRECISION to 1 to render reals with 6 significant digits, as in wire <= 2.2.0 ("3.14159").
+// Default is the shortest representation that round-trips back to the very same value.
+#ifndef WIRE_COMPAT_PRECISION
+#    define WIRE_COMPAT_PRECISION 0
+#endif
+
+#ifdef _MSC_VER
+#    define wire$snprintf  _snprintf
+#    define wire$vsnprintf _vsnprintf
+#    pragma warning( push )
+#    pragma warning( disable : 4996 )
+#else
+#    define wire$snprintf   snprintf
+#    define wire$vsnprintf  vsnprintf
+#endif
+
+// Define WIRE_STATS to 1 to count, per thread and per operation, the calls, bytes copied and bytes allocated by
+// format(), constructors from T, as<T>(), replace*(), tokenize(), split(), strip(), push_*() and strings::str().
+// Also define WIRE_STATS_TICKS to 1 to time them (rdtsc on x86, steady_clock nanoseconds elsewhere).
+// Probes compile to nothing otherwise. See wire::stats::report().
+#ifndef WIRE_STATS
+#    define WIRE_STATS 0
+#endif
+#ifndef WIRE_STATS_TICKS
+#    define WIRE_STATS_TICKS 0
+#endif
+
+#if WIRE_STATS
+#    if WIRE_STATS_TICKS && ( defined(__x86_64__) || defined(__i386__) ) && !defined(_MSC_VER)
+#        include <x86intrin.h>
+#    endif
+#    define wire$probe(OP)              wire::stats::probe wire_probe_( wire::stats::OP )
+#    define wire$probe_on(OP,S)         wire::stats::probe wire_probe_( wire::stats::OP ); wire_probe_.watch( S )
+#    define wire$probe_list_on(OP,L)    wire::stats::probe wire_probe_( wire::stats::OP ); wire_probe_.watch_list( L )
+#    define wire$probe_result(S)        wire_probe_.result( S )
+#    define wire$probe_result_list(L)   wire_probe_.result_list( L )
+
+namespace wire
+{
+    // Operation counters. Every thread counts into its own table (relaxed atomics, no contention), split by call
+    // site: the innermost live wire::stats::scope of that thread. Tables are summed up on demand, and those of
+    // finished threads are folded into a process-wide table. "allocated" is the heap capacity the operation
+    // added to its outputs, "copied" the bytes written into them.
+    namespace stats
+    {
+        enum operation { format, construct, as, replace, tokenize, split, strip, push, join, operations };
+
+        inline const char *name( operation op ) {
+            static const char *names[] = { "format", "construct", "as", "replace", "tokenize", "split", "strip", "push", "strings::str" };
+            return names[ op ];
+        }
+
+        struct totals {
+            uint64_t calls, allocated, copied, ticks;
+
+            totals() : calls( 0 ), allocated( 0 ), copied( 0 ), ticks( 0 )
+            {}
+
+            totals &operator+=( const totals &t ) {
+                return calls += t.calls, allocated += t.allocated, copied += t.copied, ticks += t.ticks, *this;
+            }
+        };
+
+        // internals, kept out of anonymous namespaces so that every translation unit shares the same tables
+
+        // written by the owning thread, zeroed by reset() from any thread: read-modify-write adds, so that a reset
+        // racing an add is never undone by a stale store
+        struct counter {
+            std::atomic< uint64_t > calls, allocated, copied, ticks;
+
+            counter() : calls( 0 ), allocated( 0 ), copied( 0 ), ticks( 0 )
+            {}
+
+            static void add( std::atomic< uint64_t > &c, uint64_t n ) {
+                c.fetch_add( n, std::memory_order_relaxed );
+            }
+
+            totals load() const {
+                totals t;
+                t.calls = calls.load( std::memory_order_relaxed ), t.allocated = allocated.load( std::memory_order_relaxed );
+                t.copied = copied.load( std::memory_order_relaxed ), t.ticks = ticks.load( std::memory_order_relaxed );
+                return t;
+            }
+
+            void clear() {
+                calls.store( 0, std::memory_order_relaxed ), allocated.store( 0, std::memory_order_relaxed );
+                copied.store( 0, std::memory_order_relaxed ), ticks.store( 0, std::memory_order_relaxed );
+            }
+        };
+
+        struct site {
+            const char *label;
+            counter ops[ operations ];
+
+            explicit site( const char *label ) : label( label )
+            {}
+        };
+
+        typedef std::map< std::string, std::vector< totals > > report_table; // site label -> totals per operation
+
+        struct thread_table;
+
+        struct registry {
+            std::mutex lock;
+            std::vector< thread_table * > live;
+            report_table retired;
+
+            // leaked: threads may still exit after static destruction
+            static registry &get() {
+                static registry *r = new registry;
+                return *r;
+            }
+        };
+
+        struct thread_table {
+            std::mutex lock; // guards sites against readers while a new one is added
+            std::deque< site > sites;
+            site *current;
+
+            thread_table() {
+                sites.emplace_back( "" );
+                current = &sites.front();
+                registry &r = registry::get();
+                std::lock_guard< std::mutex > guard( r.lock );
+                r.live.push_back( this );
+            }
+
+            ~thread_table() {
+                registry &r = registry::get();
+                std::lock_guard< std::mutex > guard( r.lock );
+                collect( r.retired );
+                r.live.erase( std::find( r.live.begin(), r.live.end(), this ) );
+            }
+
+            site *find( const char *label ) {
+                for( site &s : sites )
+                    if( s.label == label || !std::strcmp( s.label, label ) ) return &s;
+                std::lock_guard< std::mutex > guard( lock );
+                return sites.emplace_back( label ), &sites.back();
+            }
+
+            void collect( report_table &out ) {
+                std::lock_guard< std::mutex > guard( lock );
+                for( const site &s : sites ) {
+                    std::vector< totals > &row = out[ s.label ];
+                    row.resize( operations );
+                    for( int op = 0; op < operations; ++op ) row[ op ] += s.ops[ op ].load();
+                }
+            }
+
+            void clear() {
+                std::lock_guard< std::mutex > guard( lock );
+                for( site &s : sites )
+                    for( counter &c : s.ops ) c.clear();
+            }
+        };
+
+        inline thread_table &local() {
+            static thread_local thread_table table;
+            return table;
+        }
+
+        inline uint64_t now() {
+#if WIRE_STATS_TICKS && ( defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86) )
+            return __rdtsc();
+#elif WIRE_STATS_TICKS
+            return uint64_t( std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now().time_since_epoch() ).count() );
+#else
+            return 0;
+#endif
+        }
+
+        // heap bytes held by a string: 0 while its chars are inline (SSO)
+        template< typename A >
+        inline size_t heap_of( const std::basic_string< char, std::char_traits< char >, A > &s ) {
+            const char *p = s.data(), *self = (const char *)&s;
+            return p >= self && p < self + sizeof( s ) ? 0 : s.capacity();
+        }
+
+        // Counts one call of op for the calling thread's current site (plus the bytes it reports) when destroyed
+        class probe
+        {
+            public:
+
+            explicit probe( operation op ) : op( op ), start( now() ), copied( 0 ), allocated( 0 ), watched_size( 0 ), watched_heap( 0 ),
+                measure_size( 0 ), measure_heap( 0 ), watched( 0 )
+            {}
+
+            ~probe() {
+                counter &c = local().current->ops[ op ];
+                if( watched ) {
+                    size_t size = measure_size( watched ), heap = measure_heap( watched );
+                    copied += size > watched_size ? size - watched_size : 0;
+                    allocated += heap > watched_heap ? heap - watched_heap : 0;
+                }
+                counter::add( c.calls, 1 );
+                if( copied ) counter::add( c.copied, copied );
+                if( allocated ) counter::add( c.allocated, allocated );
+                if( WIRE_STATS_TICKS ) counter::add( c.ticks, now() - start );
+            }
+
+            probe( const probe & ) = delete;
+            probe &operator=( const probe & ) = delete;
+
+            // an output string (or list of strings) that outlives the probe: its growth is counted
+            template< typename S >
+            void watch( const S &s ) {
+                watched = &s, measure_size = &string_size< S >, measure_heap = &string_heap< S >;
+                watched_size = measure_size( watched ), watched_heap = measure_heap( watched );
+            }
+            template< typename L >
+            void watch_list( const L &l ) {
+                watched = &l, measure_size = &list_size< L >, measure_heap = &list_heap< L >;
+                watched_size = measure_size( watched ), watched_heap = measure_heap( watched );
+            }
+
+            // a returned output string (or list of strings)
+            template< typename S >
+            void result( const S &s ) {
+                copied += s.size(), allocated += stats::heap_of( s );
+            }
+            template< typename L >
+            void result_list( const L &l ) {
+                copied += list_size< L >( &l ), allocated += list_heap< L >( &l );
+            }
+
+            private:
+
+            template< typename S > static size_t string_size( const void *p ) { return ( (const S *)p )->size(); }
+            template< typename S > static size_t string_heap( const void *p ) { return stats::heap_of( *(const S *)p ); }
+            template< typename L > static size_t list_size( const void *p ) {
+                size_t n = 0;
+                for( const auto &s : *(const L *)p ) n += s.size();
+                return n;
+            }
+            template< typename L > static size_t list_heap( const void *p ) {
+                size_t n = 0;
+                for( const auto &s : *(const L *)p ) n += stats::heap_of( s );
+                return n;
+            }
+
+            operation op;
+            uint64_t start, copied, allocated;
+            size_t watched_size, watched_heap;
+            size_t ( *measure_size )( const void * );
+            size_t ( *measure_heap )( const void * );
+            const void *watched;
+        };
+
+        // Labels the calling thread's operations with a call site until destroyed (nests; restores the outer one).
+        // Labels are compared by pointer first, then by text, and kept by pointer: pass string literals.
+        // { wire::stats::scope here( "http.parse_headers" ); ... }
+        class scope
+        {
+            public:
+
+            explicit scope( const char *label ) : outer( local().current ) {
+                local().current = local().find( label ? label : "" );
+            }
+
+            ~scope() {
+                local().current = outer;
+            }
+
+            scope( const scope & ) = delete;
+            scope &operator=( const scope & ) = delete;
+
+            private:
+
+            site *outer;
+        };
+
+        // every site of every thread, live or finished
+        inline report_table snapshot() {
+            registry &r = registry::get();
+            std::lock_guard< std::mutex > guard( r.lock );
+            report_table all = r.retired;
+            for( thread_table *t : r.live ) t->collect( all );
+            return all;
+        }
+
+        // Totals of op for one site label (all sites when null), over every thread, live or finished
+        inline totals total( operation op, const char *label = 0 ) {
+            report_table all = snapshot();
+            totals sum;
+            for( const report_table::value_type &row : all )
+                if( !label || row.first == label ) sum += row.second[ op ];
+            return sum;
+        }
+
+        // Zeroes every counter (live threads keep counting from there; an operation in flight lands on either side)
+        inline void reset() {
+            registry &r = registry::get();
+            std::lock_guard< std::mutex > guard( r.lock );
+            r.retired.clear();
+            for( thread_table *t : r.live ) t->clear();
+        }
+    }
+}
+
+#else
+#    define wire$probe(OP)
+#    define wire$probe_on(OP,S)
+#    define wire$probe_list_on(OP,L)
+#    define wire$probe_result(S)
+#    define wire$probe_result_list(L)
+#endif
+
+namespace wire
+{
+    namespace
+    {
+        // Renders into a stack buffer first. Output that overflows it is rendered into a temporary of the exact size,
+        // so arguments pointing into self are still intact while being read; self is only written afterwards
+        inline std::string &vformat_into( std::string &self, bool replace, const char *fmt, va_list args ) {
+            using namespace std;
+            wire$probe_on( format, self );
+            char buf[ 512 ];
+            int len;
+
+            {
+                va_list copy;
+                va_copy( copy, args );
+                len = wire$vsnprintf( buf, sizeof(buf), fmt, copy );
+                va_end( copy );
+            }
+
+            if( len >= 0 && size_t(len) < sizeof(buf) )
+                return replace ? self.assign( buf, size_t(len) ) : self.append( buf, size_t(len) );
+
+            // Overflow (some runtimes report it as -1): calculate the final length
+            if( len < 0 ) {
+                va_list copy;
+                va_copy( copy, args );
+                len = wire$vsnprintf( 0, 0, fmt, copy );
+                va_end( copy );
+                if( len < 0 ) return self;
+            }
+
+            // Generate the formatted string straight into the temporary (its terminator slot takes the null)
+            std::string out( size_t(len), '\0' );
+            wire$vsnprintf( &out[0], size_t(len) + 1, fmt, args );
+            if( replace || self.empty() ) self.swap( out );
+            else self.append( out );
+            return self;
+        }
+    }
+
+    /* Public API */
+    // Function tools
+
+    // Function to do safe C-style formatting; appends to caller-owned storage. Arguments may point into self
+    static inline std::string &vformat_append( std::string &self, const char *fmt, va_list args ) {
+        return vformat_into( self, false, fmt, args );
+    }
+
+    // Function to do safe C-style formatting
+    static inline std::string format( const char *fmt, ... ) {
+        std::string self;
+        va_list args;
+        va_start( args, fmt );
+        vformat_into( self, true, fmt, args );
+        va_end( args );
+        return self;
+    }
+
+    // Function to do safe C-style formatting into caller-owned storage (capacity is reused). Arguments may point into self
+    static inline std::string &format_to( std::string &self, const char *fmt, ... ) {
+        va_list args;
+        va_start( args, fmt );
+        vformat_into( self, true, fmt, args );
+        va_end( args );
+        return self;
+    }
+
+    // Function to do safe C-style formatting at the end of caller-owned storage. Arguments may point into self
+    static inline std::string &format_append( std::string &self, const char *fmt, ... ) {
+        va_list args;
+        va_start( args, fmt );
+        vformat_into( self, false, fmt, args );
+        va_end( args );
+        return self;
+    }
+
+    /* Public API */
+    // Main class
+
+    // Substring search strategy for count(), replace1(), replace() and replace_inplace().
+    // automatic: memchr for 1-byte targets, horspool for targets of 16+ bytes, naive otherwise.
+    enum class search { automatic, memchr, naive, horspool };
+
+    namespace
+    {
+        // Locale-free number formatting
+
+        inline const char *digit_pairs() {
+            static const char table[] =
+                "00010203040506070809" "10111213141516171819" "20212223242526272829" "30313233343536373839" "40414243444546474849"
+                "50515253545556575859" "60616263646566676869" "70717273747576777879" "80818283848586878889" "90919293949596979899";
+            return table;
+        }
+
+        // Writes t backwards, ending at end. Returns first char. Room for 24 chars is always enough.
+        template< typename T >
+        inline char *format_unsigned( char *end, T t ) {
+            const char *pairs = digit_pairs();
+            while( t >= 100 ) {
+                unsigned i = unsigned( t % 100 ) * 2;
+                t /= 100;
+                *--end = pairs[ i + 1 ];
+                *--end = pairs[ i ];
+            }
+            if( t >= 10 ) {
+                unsigned i = unsigned( t ) * 2;
+                *--end = pairs[ i + 1 ];
+                *--end = pairs[ i ];
+            } else {
+                *--end = char( '0' + unsigned( t ) );
+            }
+            return end;
+        }
+
+        template< typename T >
+        inline char *format_integer( char *end, T t, std::true_type /*signed*/ ) {
+            typedef typename std::make_unsigned<T>::type U;
+            end = format_unsigned( end, t < 0 ? U( U(0) - U(t) ) : U(t) );
+            if( t < 0 ) *--end = '-';
+            return end;
+        }
+        template< typename T >
+        inline char *format_integer( char *end, T t, std::false_type /*unsigned*/ ) {
+            return format_unsigned( end, t );
+        }
+        template< typename T >
+        inline char *format_integer( char *end, T t ) {
+            return format_integer( end, t, std::integral_constant< bool, std::is_signed<T>::value >() );
+        }
+
+        inline int format_real( char *buf, size_t len, int digits, float t )       { return wire$snprintf( buf, len, "%.*g", digits, double(t) ); }
+        inline int format_real( char *buf, size_t len, int digits, double t )      { return wire$snprintf( buf, len, "%.*g", digits, t ); }
+        inline int format_real( char *buf, size_t len, int digits, long double t ) { return wire$snprintf( buf, len, "%.*Lg", digits, t ); }
+
+        inline bool parsed_back( const char *buf, float t )       { return std::strtof( buf, 0 ) == t; }
+        inline bool parsed_back( const char *buf, double t )      { return std::strtod( buf, 0 ) == t; }
+        inline bool parsed_back( const char *buf, long double t ) { return std::strtold( buf, 0 ) == t; }
+
+        // Fast path for integral reals and short decimals (0.1, 1234.25...): writes the very text the %g loop below
+        // would, without snprintf/strtod. m / 10^k is the only decimal of <= digits10 digits that rounds to t, and
+        // exact m and 10^k make the division correctly rounded. Returns 0 when not applicable (exponent notation...)
+        inline size_t format_short( char *buf, double t, unsigned max_digits, unsigned max_decimals ) {
+            static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+            bool negative = t < 0 || ( t == 0 && 1 / t < 0 );
+            double a = negative ? -t : t, limit = pow10[ max_digits ];
+            for( unsigned k = 0; k <= max_decimals && a * pow10[ k ] < limit; ++k ) {
+                double scaled = a * pow10[ k ];
+                uint64_t m = uint64_t( scaled );
+                if( double( m ) != scaled || double( m ) / pow10[ k ] != a ) continue;
+                while( k && m % 10 == 0 ) m /= 10, --k;
+                char digits[ 24 ], *end = digits + sizeof( digits ), *first = format_unsigned( end, m );
+                unsigned n = unsigned( end - first );
+                if( int( n ) - int( k ) - 1 < -4 ) return 0;
+                char *w = buf;
+                if( negative ) *w++ = '-';
+                if( n > k ) {
+                    std::memcpy( w, first, n - k ), w += n - k;
+                    if( k ) *w++ = '.', std::memcpy( w, end - k, k ), w += k;
+                } else {
+                    *w++ = '0', *w++ = '.';
+                    std::memset( w, '0', k - n ), w += k - n;
+                    std::memcpy( w, first, n ), w += n;
+                }
+                *w = '\0';
+                return size_t( w - buf );
+            }
+            return 0;
+        }
+
+        inline size_t format_short( char *buf, double t )      { return format_short( buf, t, 15, 15 ); }
+        inline size_t format_short( char *buf, float t )       { return format_short( buf, double( t ), 6, 0 ); }
+        inline size_t format_short( char *, long double )      { return 0; }
+
+        // Writes t into buf (64 chars), null terminated. Returns length.
+        // Default is the shortest %g representation that parses back to t; legacy is 6 significant digits.
+        template< typename T >
+        inline size_t format_real( char *buf, T t, bool legacy = WIRE_COMPAT_PRECISION ) {
+            enum { size = 64 };
+            int len = 0;
+            if( !legacy )
+                if( size_t fast = format_short( buf, t ) ) return fast;
+            if( legacy ) {
+                len = format_real( buf, size, 6, (long double)t );
+            } else {
+                int digits = std::numeric_limits<T>::digits10, max_digits = std::numeric_limits<T>::max_digits10;
+                bool finite = ( t == t ) && ( t - t == t - t );
+                for( ;; ++digits ) {
+                    len = format_real( buf, size, digits, t );
+                    if( !finite || digits >= max_digits || len < 0 || len >= size || parsed_back( buf, t ) ) break;
+                }
+            }
+            if( len < 0 || len >= size ) return buf[0] = '\0', 0;
+            // be locale-free: restore any localized decimal point back to '.'
+            const char *point = std::localeconv()->decimal_point;
+            if( point && point[0] && ( point[0] != '.' || point[1] ) ) {
+                if( char *found = std::strstr( buf, point ) ) {
+                    size_t skip = std::strlen( point ) - 1;
+                    *found = '.';
+                    std::memmove( found + 1, found + 1 + skip, std::strlen( found + 1 + skip ) + 1 );
+                    len -= int( skip );
+                }
+            }
+            return size_t( len );
+        }
+
+        // Allocation-free parsing, straight from a [begin,end) range.
+        // Mimics std::istream extraction: skips leading spaces, stops at first unexpected char.
+        // Returns false on failure, without any boolean guess.
+
+        inline const char *skip_spaces( const char *begin, const char *end ) {
+            while( begin < end && ( *begin == ' ' || ( *begin >= '\t' && *begin <= '\r' ) ) ) ++begin;
+            return begin;
+        }
+
+        template< typename T >
+        inline bool parse_integer( const char *begin, const char *end, T &t ) {
+            typedef typename std::make_unsigned<T>::type U;
+            begin = skip_spaces( begin, end );
+            bool negative = begin < end && *begin == '-';
+            if( begin < end && ( *begin == '-' || *begin == '+' ) ) ++begin;
+            // signed types hold one more negative magnitude; unsigned types wrap negatives around (as streams do)
+            U limit = U( std::numeric_limits<T>::max() ) + U( negative && std::is_signed<T>::value ? 1 : 0 ), u = 0;
+            const char *digits = begin;
+            for( ; begin < end && unsigned( *begin - '0' ) < 10; ++begin ) {
+                unsigned digit = unsigned( *begin - '0' );
+                if( u > ( limit - digit ) / 10 ) return false;
+                u = U( u * 10 + digit );
+            }
+            if( begin == digits ) return false;
+            t = negative ? T( U( U(0) - u ) ) : T( u );
+            return true;
+        }
+
+        inline bool convert_real( const char *buf, float &t )       { char *e; t = std::strtof( buf, &e );  return !*e; }
+        inline bool convert_real( const char *buf, double &t )      { char *e; t = std::strtod( buf, &e );  return !*e; }
+        inline bool convert_real( const char *buf, long double &t ) { char *e; t = std::strtold( buf, &e ); return !*e; }
+
+        template< typename T >
+        inline bool parse_real( const char *begin, const char *end, T &t ) {
+            // collect [sign] digits [. digits] [e [sign] digits], as streams do
+            begin = skip_spaces( begin, end );
+            const char *it = begin;
+            bool mantissa = false;
+            if( it < end && ( *it == '-' || *it == '+' ) ) ++it;
+            while( it < end && unsigned( *it - '0' ) < 10 ) ++it, mantissa = true;
+            if( it < end && *it == '.' ) for( ++it; it < end && unsigned( *it - '0' ) < 10; ) ++it, mantissa = true;
+            if( mantissa && it < end && ( *it == 'e' || *it == 'E' ) ) {
+                ++it;
+                if( it < end && ( *it == '-' || *it == '+' ) ) ++it;
+                while( it < end && unsigned( *it - '0' ) < 10 ) ++it;
+            }
+            size_t len = size_t( it - begin );
+            if( !len ) return false;
+            // strto*() needs a null terminated copy using current C locale decimal point
+            char stack[ 128 ];
+            std::string heap;
+            char *buf = len < sizeof(stack) ? stack : ( heap.assign( len + 1, '\0' ), &heap[0] );
+            std::memcpy( buf, begin, len );
+            buf[ len ] = '\0';
+            const char *point = std::localeconv()->decimal_point;
+            if( point && point[0] != '.' && point[0] && !point[1] )
+                if( char *found = (char *)std::memchr( buf, '.', len ) ) *found = point[0];
+            T v;
+            if( !convert_real( buf, v ) ) return false;
+            if( v == std::numeric_limits<T>::infinity() || v == -std::numeric_limits<T>::infinity() ) return false;
+            return t = v, true;
+        }
+
+        template< typename T >
+        inline bool parse( const char *begin, const char *end, T &t ) {
+            return !!( std::istringstream( std::string( begin, end ) ) >> t );
+        }
+
+        inline bool parse( const char *begin, const char *end, short &t )              { return parse_integer( begin, end, t ); }
+        inline bool parse( const char *begin, const char *end, unsigned short &t )     { return parse_integer( begin, end, t ); }
+        inline bool parse( const char *begin, const char *end, int &t )                { return parse_integer( begin, end, t ); }
+        inline bool parse( const char *begin, const char *end, unsigned int &t )       { return parse_integer( begin, end, t ); }
+        inline bool parse( const char *begin, const char *end, long &t )               { return parse_integer( begin, end, t ); }
+        inline bool parse( const char *begin, const char *end, unsigned long &t )      { return parse_integer( begin, end, t ); }
+        inline bool parse( const char *begin, const char *end, long long &t )          { return parse_integer( begin, end, t ); }
+        inline bool parse( const char *begin, const char *end, unsigned long long &t ) { return parse_integer( begin, end, t ); }
+
+        inline bool parse( const char *begin, const char *end, float &t )              { return parse_real( begin, end, t ); }
+        inline bool parse( const char *begin, const char *end, double &t )             { return parse_real( begin, end, t ); }
+        inline bool parse( const char *begin, const char *end, long double &t )        { return parse_real( begin, end, t ); }
+
+        inline bool parse( const char *begin, const char *end, bool &t ) {
+            long l;
+            if( !parse_integer( begin, end, l ) || ( l != 0 && l != 1 ) ) return false;
+            return t = ( l != 0 ), true;
+        }
+
+        template< typename T >
+        inline bool parse_char( const char *begin, const char *end, T &t ) {
+            int i;
+            if( end - begin == 1 ) return t = T( *begin ), true;
+            if( !parse_integer( begin, end, i ) ) return false;
+            return t = T( i ), true;
+        }
+        inline bool parse( const char *begin, const char *end, char &t )               { return parse_char( begin, end, t ); }
+        inline bool parse( const char *begin, const char *end, signed char &t )        { return parse_char( begin, end, t ); }
+        inline bool parse( const char *begin, const char *end, unsigned char &t )      { return parse_char( begin, end, t ); }
+
+        inline bool parse( const char *begin, const char *end, std::string &t ) {
+            return t.assign( begin, end ), true;
+        }
+
+        // as<T>(): parse, or guess a boolean when parsing fails
+
+        inline bool is_true( const char *begin, const char *end ) {
+            size_t len = size_t( end - begin );
+            return len && !( len == 1 && *begin == '0' ) && !( len == 5 && !std::memcmp( begin, "false", 5 ) );
+        }
+
+        template< typename T >
+        inline T as( const char *begin, const char *end ) {
+            T t;
+            if( parse( begin, end, t ) )
+                return t;
+            return (T)( is_true( begin, end ) );
+        }
+
+        template<>
+        inline char as( const char *begin, const char *end ) {
+            return end - begin == 1 ? (char)(*begin) : (char)(as<int>(begin, end));
+        }
+        template<>
+        inline signed char as( const char *begin, const char *end ) {
+            return end - begin == 1 ? (signed char)(*begin) : (signed char)(as<int>(begin, end));
+        }
+        template<>
+        inline unsigned char as( const char *begin, const char *end ) {
+            return end - begin == 1 ? (unsigned char)(*begin) : (unsigned char)(as<int>(begin, end));
+        }
+        template<>
+        inline std::string as( const char *begin, const char *end ) {
+            return std::string( begin, end );
+        }
+
+        template< typename T >
+        inline T as( const std::string &self ) {
+            return as<T>( self.data(), self.data() + self.size() );
+        }
+
+        template<>
+        inline const char *as( const std::string &self ) {
+            return self.c_str();
+        }
+        template<>
+        inline std::string as( const std::string &self ) {
+            return self;
+        }
+
+        // try_as<T>(): parse only, reports failure
+
+        template< typename T >
+        inline bool try_as( const std::string &self, T &t ) {
+            return parse( self.data(), self.data() + self.size(), t );
+        }
+
+        // ASCII case mapping. Vectorized (AVX2, SSE2, NEON) with a scalar fallback.
+
+        inline char fold( char ch ) {
+            return (unsigned char)( ch - 'a' ) < 26 ? char( ch ^ 0x20 ) : ch;
+        }
+
+        inline void ascii_case( char *str, size_t len, bool upper ) {
+            const char first = upper ? 'a' : 'A';
+            size_t i = 0;
+#if defined(__AVX2__)
+            {
+                const __m256i lo = _mm256_set1_epi8( char( first - 1 ) ), hi = _mm256_set1_epi8( char( first + 26 ) ), flip = _mm256_set1_epi8( 0x20 );
+                for( ; i + 32 <= len; i += 32 ) {
+                    __m256i v = _mm256_loadu_si256( (const __m256i *)( str + i ) );
+                    __m256i in = _mm256_and_si256( _mm256_cmpgt_epi8( v, lo ), _mm256_cmpgt_epi8( hi, v ) );
+                    _mm256_storeu_si256( (__m256i *)( str + i ), _mm256_xor_si256( v, _mm256_and_si256( in, flip ) ) );
+                }
+            }
+#endif
+#if WIRE_SSE2
+            {
+                const __m128i lo = _mm_set1_epi8( char( first - 1 ) ), hi = _mm_set1_epi8( char( first + 26 ) ), flip = _mm_set1_epi8( 0x20 );
+                for( ; i + 16 <= len; i += 16 ) {
+                    __m128i v = _mm_loadu_si128( (const __m128i *)( str + i ) );
+                    __m128i in = _mm_and_si128( _mm_cmpgt_epi8( v, lo ), _mm_cmplt_epi8( v, hi ) );
+                    _mm_storeu_si128( (__m128i *)( str + i ), _mm_xor_si128( v, _mm_and_si128( in, flip ) ) );
+                }
+            }
+#elif WIRE_NEON
+            {
+                const uint8x16_t lo = vdupq_n_u8( (unsigned char)first ), span = vdupq_n_u8( 26 ), flip = vdupq_n_u8( 0x20 );
+                for( ; i + 16 <= len; i += 16 ) {
+                    uint8x16_t v = vld1q_u8( (const unsigned char *)( str + i ) );
+                    uint8x16_t in = vcltq_u8( vsubq_u8( v, lo ), span );
+                    vst1q_u8( (unsigned char *)( str + i ), veorq_u8( v, vandq_u8( in, flip ) ) );
+                }
+            }
+#endif
+            for( ; i < len; ++i )
+                if( (unsigned char)( str[i] - first ) < 26 ) str[i] ^= 0x20;
+        }
+
+        inline bool equal_nocase( const char *a, const char *b, size_t len ) {
+            for( size_t i = 0; i < len; ++i )
+                if( a[i] != b[i] && fold( a[i] ) != fold( b[i] ) ) return false;
+            return true;
+        }
+
+        // Glob matching: '*' matches any sequence, '?' matches any char but '.'
+        // Iterative, with a single backtracking point (the last '*' seen): O(pattern*str) worst case, no recursion.
+        inline bool match( const char *pattern, const char *pattern_end, const char *str, const char *str_end, bool nocase = false ) {
+            const char *star = 0, *resume = 0;
+            while( str < str_end ) {
+                if( pattern < pattern_end && *pattern == '*' ) {
+                    star = ++pattern, resume = str;
+                    continue;
+                }
+                if( pattern < pattern_end && ( *pattern == '?' ? *str != '.' : ( *str == *pattern || ( nocase && fold(*str) == fold(*pattern) ) ) ) ) {
+                    ++pattern, ++str;
+                    continue;
+                }
+                if( !star ) return false;
+                pattern = star, str = ++resume;
+            }
+            while( pattern < pattern_end && *pattern == '*' ) ++pattern;
+            return pattern == pattern_end;
+        }
+
+        // Non-empty needle finder. naive = memchr on the first byte + memcmp; horspool = Boyer-Moore-Horspool,
+        // skipping up to len bytes per probe (its 256-entry shift table is only built when selected).
+        struct finder {
+            const char *needle;
+            size_t len;
+            search algo;
+            size_t shift[256];
+
+            finder( const char *needle, size_t len, search hint = search::automatic ) : needle( needle ), len( len ), algo( hint ) {
+                if( algo == search::automatic ) algo = len == 1 ? search::memchr : len >= 16 ? search::horspool : search::naive;
+                if( algo == search::memchr && len != 1 ) algo = search::naive;
+                if( algo == search::horspool ) {
+                    for( size_t c = 0; c < 256; ++c ) shift[c] = len;
+                    for( size_t i = 0; i + 1 < len; ++i ) shift[ (unsigned char)needle[i] ] = len - 1 - i;
+                }
+            }
+
+            const char *find( const char *begin, const char *end ) const {
+                if( size_t( end - begin ) < len ) return 0;
+                if( algo == search::memchr ) return (const char *)std::memchr( begin, needle[0], end - begin );
+                if( algo == search::naive ) {
+                    for( const char *last = end - len; begin <= last; ++begin ) {
+                        begin = (const char *)std::memchr( begin, needle[0], last - begin + 1 );
+                        if( !begin ) return 0;
+                        if( !std::memcmp( begin + 1, needle + 1, len - 1 ) ) return begin;
+                    }
+                    return 0;
+                }
+                const unsigned char tail = needle[len - 1];
+                for( const char *last = end - len; begin <= last; begin += shift[ (unsigned char)begin[len - 1] ] )
+                    if( (unsigned char)begin[len - 1] == tail && !std::memcmp( begin, needle, len - 1 ) ) return begin;
+                return 0;
+            }
+        };
+
+        // Byte-set kernels for wire::charset: membership bits of a whole 64-byte block in a single call.
+        // AVX2: two nibble lookup tables, any set. SSE2: one compare per member, sets of 16 bytes tops.
+        // NEON (AArch64): same nibble tables as AVX2.
+
+        inline unsigned low_bit( uint64_t mask ) {
+#if defined(_MSC_VER) && !defined(__clang__)
+            unsigned long i;
+#   if defined(_M_X64) || defined(_M_ARM64)
+            _BitScanForward64( &i, mask );
+#   else
+            if( !_BitScanForward( &i, (unsigned long)mask ) ) _BitScanForward( &i, (unsigned long)( mask >> 32 ) ), i += 32;
+#   endif
+            return unsigned( i );
+#else
+            return unsigned( __builtin_ctzll( mask ) );
+#endif
+        }
+
+        inline unsigned high_bit( uint64_t mask ) {
+#if defined(_MSC_VER) && !defined(__clang__)
+            unsigned long i;
+#   if defined(_M_X64) || defined(_M_ARM64)
+            _BitScanReverse64( &i, mask );
+#   else
+            if( mask >> 32 ) _BitScanReverse( &i, (unsigned long)( mask >> 32 ) ), i += 32; else _BitScanReverse( &i, (unsigned long)mask );
+#   endif
+            return unsigned( i );
+#else
+            return 63 - unsigned( __builtin_clzll( mask ) );
+#endif
+        }
+
+        inline unsigned popcount( uint64_t mask ) {
+#if defined(__GNUC__)
+            return unsigned( __builtin_popcountll( mask ) );
+#else
+            unsigned n = 0;
+            for( ; mask; mask &= mask - 1 ) n++;
+            return n;
+#endif
+        }
+
+#if WIRE_AVX2
+#   if WIRE_AVX2 == 2
+        inline bool cpu_avx2() {
+            static const bool yes = ( __builtin_cpu_init(), __builtin_cpu_supports( "avx2" ) != 0 );
+            return yes;
+        }
+#   else
+        inline bool cpu_avx2() {
+            return true;
+        }
+#   endif
+
+        WIRE_AVX2_TARGET inline uint64_t set_mask_avx2( const unsigned char *nibbles, const char *p ) {
+            const __m256i t0 = _mm256_broadcastsi128_si256( _mm_loadu_si128( (const __m128i *)nibbles ) );
+            const __m256i t1 = _mm256_broadcastsi128_si256( _mm_loadu_si128( (const __m128i *)( nibbles + 16 ) ) );
+            const __m256i s0 = _mm256_setr_epi8( 1,2,4,8,16,32,64,-128, 0,0,0,0,0,0,0,0, 1,2,4,8,16,32,64,-128, 0,0,0,0,0,0,0,0 );
+            const __m256i s1 = _mm256_setr_epi8( 0,0,0,0,0,0,0,0, 1,2,4,8,16,32,64,-128, 0,0,0,0,0,0,0,0, 1,2,4,8,16,32,64,-128 );
+            const __m256i low = _mm256_set1_epi8( 0x0F ), zero = _mm256_setzero_si256();
+            uint64_t mask = 0;
+            for( int half = 0; half < 2; ++half ) {
+                __m256i v = _mm256_loadu_si256( (const __m256i *)( p + half * 32 ) );
+                __m256i lo = _mm256_and_si256( v, low ), hi = _mm256_and_si256( _mm256_srli_epi16( v, 4 ), low );
+                __m256i hit = _mm256_or_si256( _mm256_and_si256( _mm256_shuffle_epi8( t0, lo ), _mm256_shuffle_epi8( s0, hi ) ),
+                                               _mm256_and_si256( _mm256_shuffle_epi8( t1, lo ), _mm256_shuffle_epi8( s1, hi ) ) );
+                mask |= uint64_t( ~unsigned( _mm256_movemask_epi8( _mm256_cmpeq_epi8( hit, zero ) ) ) ) << ( half * 32 );
+            }
+            return mask;
+        }
+#endif
+
+#if WIRE_SSE2
+        inline uint64_t set_mask_sse2( const unsigned char *list, unsigned n, const char *p ) {
+            uint64_t mask = 0;
+            for( int quarter = 0; quarter < 4; ++quarter ) {
+                __m128i v = _mm_loadu_si128( (const __m128i *)( p + quarter * 16 ) ), hit = _mm_setzero_si128();
+                for( unsigned i = 0; i < n; ++i ) hit = _mm_or_si128( hit, _mm_cmpeq_epi8( v, _mm_set1_epi8( char( list[i] ) ) ) );
+                mask |= uint64_t( unsigned( _mm_movemask_epi8( hit ) ) ) << ( quarter * 16 );
+            }
+            return mask;
+        }
+#elif WIRE_NEON && defined(__aarch64__)
+        inline uint64_t set_mask_neon( const unsigned char *nibbles, const char *p ) {
+            static const unsigned char bits[48] = { 1,2,4,8,16,32,64,128, 0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0, 1,2,4,8,16,32,64,128,
+                                                    1,2,4,8,16,32,64,128, 1,2,4,8,16,32,64,128 };
+            const uint8x16_t t0 = vld1q_u8( nibbles ), t1 = vld1q_u8( nibbles + 16 ), s0 = vld1q_u8( bits ), s1 = vld1q_u8( bits + 16 );
+            const uint8x16_t weights = vld1q_u8( bits + 32 ), low = vdupq_n_u8( 0x0F );
+            uint8x16_t in[4];
+            for( int quarter = 0; quarter < 4; ++quarter ) {
+                uint8x16_t v = vld1q_u8( (const unsigned char *)p + quarter * 16 ), lo = vandq_u8( v, low ), hi = vshrq_n_u8( v, 4 );
+                uint8x16_t hit = vorrq_u8( vandq_u8( vqtbl1q_u8( t0, lo ), vqtbl1q_u8( s0, hi ) ), vandq_u8( vqtbl1q_u8( t1, lo ), vqtbl1q_u8( s1, hi ) ) );
+                in[quarter] = vandq_u8( vtstq_u8( hit, hit ), weights );
+            }
+            uint8x16_t sum = vpaddq_u8( vpaddq_u8( in[0], in[1] ), vpaddq_u8( in[2], in[3] ) );
+            sum = vpaddq_u8( sum, sum );
+            return vgetq_lane_u64( vreinterpretq_u64_u8( sum ), 0 );
+        }
+#endif
+
+        // Hexfloat ("%a") kernels behind wire::precise(), bit-exact and locale-free. The layout follows glibc: a
+        // leading 1 bit ("0x1.8p+1"), or a leading nibble for 64-bit long doubles ("0xcp-2"); subnormals keep the
+        // minimum exponent ("0x0.8p-1022"). Trailing zero nibbles are dropped.
+
+        inline size_t hex_special( char *out, bool negative, bool nan ) {
+            const char *text = nan ? "NaN" : negative ? "-INF" : "INF";
+            size_t len = std::strlen( text );
+            return std::memcpy( out, text, len ), len;
+        }
+
+        // sign, "0x", lead digit, up to count fraction nibbles off the top of hi:lo, 'p', signed decimal exponent
+        inline size_t hex_write( char *out, bool negative, unsigned lead, uint64_t hi, uint64_t lo, unsigned count, int exponent ) {
+            static const char digits[] = "0123456789abcdef";
+            char *w = out;
+            if( negative ) *w++ = '-';
+            *w++ = '0', *w++ = 'x', *w++ = digits[ lead ];
+            while( count > 16 && !( ( lo >> ( 64 - 4 * ( count - 16 ) ) ) & 15 ) ) --count;
+            if( count <= 16 ) while( count && !( ( hi >> ( 64 - 4 * count ) ) & 15 ) ) --count;
+            if( count ) *w++ = '.';
+            for( unsigned i = 0; i < count; ++i ) *w++ = digits[ ( i < 16 ? hi >> ( 60 - 4 * i ) : lo >> ( 60 - 4 * ( i - 16 ) ) ) & 15 ];
+            *w++ = 'p', *w++ = exponent < 0 ? '-' : '+';
+            unsigned e = exponent < 0 ? 0u - unsigned( exponent ) : unsigned( exponent );
+            char tmp[ 8 ], *t = tmp;
+            do *t++ = char( '0' + e % 10 ); while( e /= 10 );
+            while( t > tmp ) *w++ = *--t;
+            return size_t( w - out );
+        }
+
+        template< typename T >
+        inline size_t hex_format( char *out, T v ) {
+            typedef std::numeric_limits< T > limits;
+            bool negative = std::signbit( v );
+            if( v != v || v == limits::infinity() || v == -limits::infinity() ) return hex_special( out, negative, v != v );
+            if( v == 0 ) return hex_write( out, negative, 0, 0, 0, 0, 0 );
+            const int lead_bits = limits::digits == 64 ? 4 : 1;
+            int e;
+            std::frexp( v, &e );
+            int exponent = ( e < limits::min_exponent ? limits::min_exponent : e ) - lead_bits;
+            T scaled = std::ldexp( negative ? -v : v, -exponent );
+            unsigned lead = unsigned( scaled );
+            T top = std::ldexp( scaled - T( lead ), 64 );
+            uint64_t hi = uint64_t( top ), lo = uint64_t( std::ldexp( top - T( hi ), 64 ) );
+            return hex_write( out, negative, lead, hi, lo, unsigned( limits::digits - lead_bits + 3 ) / 4, exponent );
+        }
+
+        // IEEE binary64 straight from its bits
+        inline size_t hex_format( char *out, double v ) {
+            if( !std::numeric_limits< double >::is_iec559 ) return hex_format< double >( out, v );
+            uint64_t bits;
+            std::memcpy( &bits, &v, sizeof( bits ) );
+            bool negative = ( bits >> 63 ) != 0;
+            unsigned biased = unsigned( bits >> 52 ) & 0x7ff;
+            uint64_t fraction = bits & ( ( uint64_t(1) << 52 ) - 1 );
+            if( biased == 0x7ff ) return hex_special( out, negative, fraction != 0 );
+            if( !biased && !fraction ) return hex_write( out, negative, 0, 0, 0, 0, 0 );
+            return hex_write( out, negative, biased ? 1 : 0, fraction << 12, 0, 13, biased ? int( biased ) - 1023 : -1022 );
+        }
+
+        // table lookup: digits and letters mix unpredictably in the mantissa
+        inline int hex_digit( char c ) {
+            static const signed char values[ 256 ] = {
+                -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+                -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,  0, 1, 2, 3, 4, 5, 6, 7, 8, 9,-1,-1,-1,-1,-1,-1,
+                -1,10,11,12,13,14,15,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+                -1,10,11,12,13,14,15,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+                -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+                -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+                -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+                -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1 };
+            return values[ (unsigned char)c ];
+        }
+
+        inline bool starts_with_nocase( const char *begin, const char *end, const char *word ) {
+            for( ; *word; ++word, ++begin )
+                if( begin == end || ( *begin | 0x20 ) != *word ) return false;
+            return true;
+        }
+
+        // [spaces] [sign] ( inf | nan | 0x hexdigits [. hexdigits] [p [sign] digits] ), anything else as a decimal.
+        // Up to 64 significant bits are kept, plus a guard and a sticky bit, then rounded to nearest even once
+        // (long doubles wider than 64 bits accumulate as many bits as they hold instead).
+        template< typename T >
+        inline bool parse_hex( const char *begin, const char *end, T &t ) {
+            typedef std::numeric_limits< T > limits;
+            begin = skip_spaces( begin, end );
+            const char *it = begin;
+            bool negative = it < end && *it == '-';
+            if( it < end && ( *it == '-' || *it == '+' ) ) ++it;
+            if( starts_with_nocase( it, end, "inf" ) ) return t = negative ? -limits::infinity() : limits::infinity(), true;
+            if( starts_with_nocase( it, end, "nan" ) ) return t = negative ? -limits::quiet_NaN() : limits::quiet_NaN(), true;
+            if( end - it < 3 || it[0] != '0' || ( it[1] | 0x20 ) != 'x' ) return parse_real( begin, end, t );
+
+            const bool wide = limits::digits > 64;
+            const T wide_limit = wide ? std::ldexp( T( 1 ), limits::digits - 4 ) : T( 0 );
+            uint64_t m = 0;
+            T acc = 0;
+            long e2 = 0;
+            bool point = false, any = false, guarded = false, guard = false, sticky = false;
+            for( it += 2; it < end; ++it ) {
+                if( *it == '.' && !point ) { point = true; continue; }
+                int d = hex_digit( *it );
+                if( d < 0 ) break;
+                any = true;
+                if( point ) e2 -= 4;
+                if( wide ) {
+                    if( acc < wide_limit ) acc = acc * 16 + T( d );
+                    else e2 += 4;
+                    continue;
+                }
+                if( m < ( uint64_t(1) << 60 ) ) { m = m * 16 + unsigned( d ); continue; }
+                // m is full: its free top bits take the nibble's high bits, the rest feeds guard and sticky
+                unsigned room = 63 - high_bit( m ), bits = 4 - room, rest = unsigned( d ) & ( ( 1u << bits ) - 1 );
+                if( room ) m = m << room | ( unsigned( d ) >> bits );
+                e2 += long( bits );
+                if( !guarded ) guarded = true, guard = ( ( rest >> ( bits - 1 ) ) & 1 ) != 0, rest &= ( 1u << ( bits - 1 ) ) - 1;
+                sticky = sticky || rest;
+            }
+            if( !any ) return parse_real( begin, end, t );
+            if( it < end && ( *it | 0x20 ) == 'p' ) {
+                const char *p = it + 1, *digits;
+                bool minus = p < end && *p == '-';
+                if( p < end && ( *p == '-' || *p == '+' ) ) ++p;
+                long x = 0;
+                for( digits = p; p < end && unsigned( *p - '0' ) < 10; ++p ) if( x < 100000000 ) x = x * 10 + ( *p - '0' );
+                if( p > digits ) e2 += minus ? -x : x;
+            }
+            int exponent = int( e2 < -200000 ? -200000 : e2 > 200000 ? 200000 : e2 );
+            if( wide ) return t = std::ldexp( negative ? -acc : acc, exponent ), true;
+            if( !m ) return t = negative ? -T( 0 ) : T( 0 ), true;
+
+            // round once, to the bits the target holds at this magnitude (fewer for subnormals)
+            int n = int( high_bit( m ) ) + 1, precision = limits::digits;
+            long top = long( exponent ) + n - 1;
+            if( top < limits::min_exponent - 1 ) precision -= int( std::min< long >( limits::min_exponent - 1 - top, limits::digits + 1 ) );
+            int drop = n - precision;
+            bool half = guard, below = sticky;
+            if( drop > n ) half = false, m = 0;
+            else if( drop == 64 ) half = ( m >> 63 ) != 0, below = below || guard || ( m << 1 ), m = 0;
+            else if( drop > 0 ) {
+                half = ( ( m >> ( drop - 1 ) ) & 1 ) != 0;
+                below = below || guard || ( m & ( ( uint64_t(1) << ( drop - 1 ) ) - 1 ) );
+                m >>= drop;
+            }
+            if( drop > 0 ) exponent += drop;
+            if( half && ( below || ( m & 1 ) ) && !++m ) m = uint64_t(1) << 63, exponent += 1;
+            T v = std::ldexp( T( m ), exponent );
+            return t = negative ? -v : v, true;
+        }
+    }
+
+    // Convert numbers <-> strings in the most precise way (C99 hexfloat, "%a"): bit-exact and locale-free.
+    // precise_to() writes into a caller buffer (no terminator) and returns the length, or 0 and writes nothing
+    // when size is too short; precise_max bytes always suffice. floats print as the double they widen to.
+    // precise_from() parses a leading number (decimals too), stops at the first unexpected char and returns
+    // false when there is none. Infinities and NaNs print as "INF", "-INF" and "NaN" and parse back as such.
+
+    enum { precise_max = 48 };
+
+    static inline size_t precise_to( char *buf, size_t size, double t ) {
+        char tmp[ precise_max ];
+        size_t len = hex_format( tmp, t );
+        return len <= size ? ( std::memcpy( buf, tmp, len ), len ) : 0;
+    }
+    static inline size_t precise_to( char *buf, size_t size, float t ) {
+        return precise_to( buf, size, double( t ) );
+    }
+    static inline size_t precise_to( char *buf, size_t size, long double t ) {
+        char tmp[ precise_max ];
+        size_t len = hex_format( tmp, t );
+        return len <= size ? ( std::memcpy( buf, tmp, len ), len ) : 0;
+    }
+
+    static inline bool precise_from( const char *begin, const char *end, float &t )       { return parse_hex( begin, end, t ); }
+    static inline bool precise_from( const char *begin, const char *end, double &t )      { return parse_hex( begin, end, t ); }
+    static inline bool precise_from( const char *begin, const char *end, long double &t ) { return parse_hex( begin, end, t ); }
+
+    static inline std::string precise( const float &t ) {
+        char buf[ precise_max ];
+        return std::string( buf, precise_to( buf, sizeof( buf ), t ) );
+    }
+    static inline std::string precise( const double &t ) {
+        char buf[ precise_max ];
+        return std::string( buf, precise_to( buf, sizeof( buf ), t ) );
+    }
+    static inline std::string precise( const long double &t ) {
+        char buf[ precise_max ];
+        return std::string( buf, precise_to( buf, sizeof( buf ), t ) );
+    }
+    // integers print as long doubles, as they always did
+    template< typename T >
+    static inline typename std::enable_if< std::is_integral< T >::value, std::string >::type precise( const T &t ) {
+        return precise( (long double)t );
+    }
+
+    // 0 when nothing parses
+    static inline long double precise( const char *begin, const char *end ) {
+        long double ld = 0;
+        return precise_from( begin, end, ld ), ld;
+    }
+    static inline long double precise( const std::string &t ) {
+        return precise( t.data(), t.data() + t.size() );
+    }
+
+    // 256-bit byte set (delimiters, strip chars...), built once and queried per byte.
+    // find()/find_not()/rfind_not()/count() scan with the widest SIMD kernel available (AVX2 picked at runtime).
+
+    class charset
+    {
+        public:
+
+        charset() : bits(), nibbles(), list(), members( 0 )
+        {}
+
+        charset( const char *chars, size_t len ) : bits(), nibbles(), list(), members( 0 )
+        {
+            for( size_t i = 0; i < len; ++i ) add( chars[i] );
+        }
+
+        explicit charset( const char *chars ) : charset( chars, std::strlen( chars ) )
+        {}
+
+        explicit charset( const std::string &chars ) : charset( chars.data(), chars.size() )
+        {}
+
+        void add( char ch ) {
+            const unsigned char c = (unsigned char)ch;
+            if( has( ch ) ) return;
+            bits[ c >> 6 ] |= uint64_t(1) << ( c & 63 );
+            nibbles[ ( c >> 7 ) * 16 + ( c & 15 ) ] |= (unsigned char)( 1 << ( ( c >> 4 ) & 7 ) );
+            if( members < sizeof( list ) ) list[ members ] = c;
+            members++;
+        }
+
+        bool has( char ch ) const {
+            return ( bits[ (unsigned char)ch >> 6 ] >> ( (unsigned char)ch & 63 ) ) & 1;
+        }
+
+        size_t size() const {
+            return members;
+        }
+
+        // true when mask() runs a SIMD kernel for this set
+        bool vectorized() const {
+#if WIRE_AVX2
+            if( cpu_avx2() ) return true;
+#endif
+#if WIRE_SSE2
+            return members <= sizeof( list );
+#elif WIRE_NEON && defined(__aarch64__)
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        // membership bits of the (up to) 64 chars at p; chars past end are reported as non-members
+        uint64_t mask( const char *p, const char *end ) const {
+            uint64_t m = 0;
+            if( end - p >= 64 && members ) {
+#if WIRE_AVX2
+                if( cpu_avx2() ) return set_mask_avx2( nibbles, p );
+#endif
+#if WIRE_SSE2
+                if( members <= sizeof( list ) ) return set_mask_sse2( list, members, p );
+#elif WIRE_NEON && defined(__aarch64__)
+                return set_mask_neon( nibbles, p );
+#endif
+            }
+            for( size_t i = 0, n = end - p < 64 ? size_t( end - p ) : 64; i < n; ++i )
+                m |= uint64_t( has( p[i] ) ) << i;
+            return m;
+        }
+
+        // first char in the set / not in the set, or end
+        const char *find( const char *begin, const char *end ) const {
+            if( begin < end && has( *begin ) ) return begin;
+            if( !vectorized() ) return scan( begin, end, true );
+            for( ; begin < end; begin += end - begin < 64 ? end - begin : 64 )
+                if( uint64_t m = mask( begin, end ) ) return begin + low_bit( m );
+            return end;
+        }
+
+        const char *find_not( const char *begin, const char *end ) const {
+            if( begin < end && !has( *begin ) ) return begin;
+            if( end - begin < 64 || !vectorized() ) return scan( begin, end, false );
+            for( ; begin < end; begin += end - begin < 64 ? end - begin : 64 )
+                if( uint64_t m = ~mask( begin, end ) ) return low_bit( m ) < size_t( end - begin ) ? begin + low_bit( m ) : end;
+            return end;
+        }
+
+        // right after the last char not in the set, or begin
+        const char *rfind_not( const char *begin, const char *end ) const {
+            if( begin < end && !has( end[-1] ) ) return end;
+            if( end - begin < 64 || !vectorized() ) {
+                while( end > begin && has( end[-1] ) ) --end;
+                return end;
+            }
+            for( size_t n; end > begin; end -= n ) {
+                n = end - begin < 64 ? size_t( end - begin ) : 64;
+                if( uint64_t m = ~mask( end - n, end ) & ( ~uint64_t(0) >> ( 64 - n ) ) ) return end - n + high_bit( m ) + 1;
+            }
+            return end;
+        }
+
+        size_t count( const char *begin, const char *end ) const {
+            size_t n = 0;
+            for( ; begin < end; begin += end - begin < 64 ? end - begin : 64 ) n += popcount( mask( begin, end ) );
+            return n;
+        }
+
+        // Forward walk that keeps the mask of the current 64-char block, so consecutive
+        // short tokens cost a bit scan each instead of a kernel call.
+        struct cursor {
+            const charset *set;
+            const char *base, *last;
+            uint64_t bits;
+
+            cursor() : set( 0 ), base( 0 ), last( 0 ), bits( 0 )
+            {}
+
+            cursor( const charset *set, const char *begin, const char *end ) : set( set ), base( begin ), last( end ), bits( set->mask( begin, end ) )
+            {}
+
+            // first char at or after p (never behind a previous result) whose membership equals member, or last
+            const char *next( const char *p, bool member ) {
+                while( p < last ) {
+                    if( p - base >= 64 ) base = p, bits = set->mask( base, last );
+                    uint64_t m = ( member ? bits : ~bits ) >> ( p - base );
+                    if( m ) {
+                        size_t at = size_t( p - base ) + low_bit( m );
+                        return at < size_t( last - base ) ? base + at : last;
+                    }
+                    if( last - base <= 64 ) return last;
+                    p = base + 64;
+                }
+                return last;
+            }
+        };
+
+        private:
+
+        const char *scan( const char *begin, const char *end, bool member ) const {
+            while( begin < end && has( *begin ) != member ) ++begin;
+            return begin;
+        }
+
+        uint64_t bits[ 4 ];
+        unsigned char nibbles[ 32 ]; // [high nibble >= 8][low nibble] -> bit ( high nibble & 7 )
+        unsigned char list[ 16 ];    // first members, for per-member compares
+        unsigned members;
+    };
+
+    class pattern;
+    class tokens;
+    class splits;
+    template< size_t N > class small_string;
+
+    template< typename Alloc = std::allocator< char > > class basic_string;
+    typedef basic_string<> string;
+
+    // Non-owning, read-only view over chars (pointer+length) featuring the extended read-only API.
+    // Slicing methods return views, so pipelines do not touch the heap. Viewed chars must outlive the view.
+    // Materialize results with .str() or wire::string( view ).
+
+    class string_view
+    {
+        public:
+
+        static const size_t npos = size_t(-1);
+
+        string_view() : ptr( "" ), len( 0 )
+        {}
+
+        string_view( const char *ptr, size_t len ) : ptr( ptr ), len( len )
+        {}
+
+        string_view( const char *cstr ) : ptr( cstr ? cstr : "" ), len( cstr ? std::strlen( cstr ) : 0 )
+        {}
+
+        string_view( const std::string &str ) : ptr( str.data() ), len( str.size() )
+        {}
+
+        template< typename A >
+        string_view( const std::basic_string< char, std::char_traits< char >, A > &str ) : ptr( str.data() ), len( str.size() )
+        {}
+
+        const char *data() const { return ptr; }
+        const char *begin() const { return ptr; }
+        const char *end() const { return ptr + len; }
+        size_t size() const { return len; }
+        size_t length() const { return len; }
+        bool empty() const { return !len; }
+
+        // at() extended behaviour: "hello"[5] = h, "hello"[-1] = o; empty views return '\0'
+        const char &at( const int &pos ) const
+        {
+            static const char sentinel = '\0';
+            signed size = (signed)(len);
+            if( unsigned(pos) < unsigned(size) )
+                return ptr[ pos ];
+            if( size )
+                return ptr[ pos >= 0 ? pos % size : size - 1 + ((pos+1) % size) ];
+            return sentinel;
+        }
+
+        const char &operator[]( const int &pos ) const {
+            return at(pos);
+        }
+
+        const char &front() const {
+            return at(0);
+        }
+
+        const char &back() const {
+            return at(-1);
+        }
+
+        string_view substr( size_t pos, size_t n = npos ) const
+        {
+            pos = pos < len ? pos : len;
+            return string_view( ptr + pos, n < len - pos ? n : len - pos );
+        }
+
+        size_t find( const char &ch, size_t pos = 0 ) const
+        {
+            if( pos >= len ) return npos;
+            const char *found = (const char *)std::memchr( ptr + pos, ch, len - pos );
+            return found ? size_t( found - ptr ) : npos;
+        }
+
+        size_t find( const string_view &substr, size_t pos = 0 ) const
+        {
+            if( substr.len == 0 ) return pos <= len ? pos : npos;
+            if( pos >= len ) return npos;
+            const char *found = finder( substr.ptr, substr.len, search::naive ).find( ptr + pos, end() );
+            return found ? size_t( found - ptr ) : npos;
+        }
+
+        // tools
+
+        std::string str( const std::string &pre = std::string(), const std::string &post = std::string() ) const
+        {
+            std::string out;
+            out.reserve( pre.size() + len + post.size() );
+            return out.append( pre ).append( ptr, len ).append( post );
+        }
+
+        bool matches( const string_view &pattern ) const
+        {
+            return match( pattern.begin(), pattern.end(), begin(), end() );
+        }
+
+        bool matchesi( const string_view &pattern ) const
+        {
+            return match( pattern.begin(), pattern.end(), begin(), end(), true );
+        }
+
+        bool matches( const wire::pattern &pattern ) const;
+        bool matchesi( const wire::pattern &pattern ) const;
+
+        size_t count( const string_view &substr, search hint = search::automatic ) const
+        {
+            size_t n = 0;
+            if( substr.empty() ) return 0;
+            if( substr.len == 1 && ( hint == search::automatic || hint == search::memchr ) ) return charset( substr.ptr, 1 ).count( ptr, end() );
+            finder f( substr.ptr, substr.len, hint );
+            for( const char *p = ptr; ( p = f.find( p, end() ) ); p += substr.len ) n++;
+            return n;
+        }
+
+        string_view left_of( const string_view &substring ) const
+        {
+            size_t pos = find( substring );
+            return pos == npos ? *this : substr( 0, pos );
+        }
+
+        string_view right_of( const string_view &substring ) const
+        {
+            size_t pos = find( substring );
+            return pos == npos ? *this : substr( pos + 1 );
+        }
+
+        // Return a view with leading/trailing/both characters removed (default chars: space)
+        string_view lstrip( const string_view &chars = string_view() ) const { return strip( chars, true, false ); }
+        string_view ltrim( const string_view &chars = string_view() ) const { return strip( chars, true, false ); }
+        string_view rstrip( const string_view &chars = string_view() ) const { return strip( chars, false, true ); }
+        string_view rtrim( const string_view &chars = string_view() ) const { return strip( chars, false, true ); }
+        string_view strip( const string_view &chars = string_view() ) const { return strip( chars, true, true ); }
+        string_view trim( const string_view &chars = string_view() ) const { return strip( chars, true, true ); }
+
+        bool starts_with( const string_view &prefix ) const
+        {
+            return len >= prefix.len && !std::memcmp( ptr, prefix.ptr, prefix.len );
+        }
+
+        bool ends_with( const string_view &suffix ) const
+        {
+            return len >= suffix.len && !std::memcmp( ptr + len - suffix.len, suffix.ptr, suffix.len );
+        }
+
+        bool starts_withi( const string_view &prefix ) const
+        {
+            return len >= prefix.len && equal_nocase( ptr, prefix.ptr, prefix.len );
+        }
+
+        bool ends_withi( const string_view &suffix ) const
+        {
+            return len >= suffix.len && equal_nocase( ptr + len - suffix.len, suffix.ptr, suffix.len );
+        }
+
+        // lazy ranges: for( wire::string_view token : view.tokens( ", " ) ) ...
+        wire::tokens tokens( const string_view &delimiters ) const;
+        wire::splits splits( const string_view &delimiters ) const;
+
+        std::deque< string_view > tokenize( const string_view &delimiters ) const;
+
+        // tokenize_incl_separators
+        std::deque< string_view > split( const string_view &delimiters ) const;
+
+        // conversion
+
+        template< typename T >
+        T as() const
+        {
+            return wire::as<T>( begin(), end() );
+        }
+
+        template< typename T >
+        bool try_as( T &t ) const
+        {
+            return parse( begin(), end(), t );
+        }
+
+        // comparison
+
+        friend bool operator ==( const string_view &a, const string_view &b ) {
+            return a.len == b.len && !std::memcmp( a.ptr, b.ptr, a.len );
+        }
+        friend bool operator !=( const string_view &a, const string_view &b ) {
+            return !( a == b );
+        }
+        friend bool operator <( const string_view &a, const string_view &b ) {
+            int cmp = std::memcmp( a.ptr, b.ptr, a.len < b.len ? a.len : b.len );
+            return cmp ? cmp < 0 : a.len < b.len;
+        }
+
+        inline friend std::ostream &operator <<( std::ostream &os, const string_view &self ) {
+            return os.write( self.ptr, std::streamsize( self.len ) );
+        }
+
+        private:
+
+        template< typename > friend class basic_string;
+
+        string_view strip( const string_view &chars, bool strip_left, bool strip_right ) const
+        {
+            // default chars: space, as std::isspace() in the "C" locale. Built once, not per call
+            static const charset spaces( " \t\n\v\f\r", 6 );
+            if( chars.empty() ) return strip( spaces, strip_left, strip_right );
+            if( len >= 64 ) return strip( charset( chars.data(), chars.size() ), strip_left, strip_right );
+
+            // short input: the edges are a few chars, cheaper to look up in chars than to build a set
+            const char *i = begin(), *j = end();
+            if( strip_left ) while( i < j && std::memchr( chars.data(), *i, chars.size() ) ) ++i;
+            if( strip_right ) while( j > i && std::memchr( chars.data(), j[-1], chars.size() ) ) --j;
+            return string_view( i, size_t( j - i ) );
+        }
+
+        string_view strip( const charset &set, bool strip_left, bool strip_right ) const
+        {
+            const char *i = begin(), *j = end();
+
+            if( strip_left ) i = set.find_not( i, j );
+            if( strip_right ) j = set.rfind_not( i, j );
+
+            return string_view( i, size_t( j - i ) );
+        }
+
+        const char *ptr;
+        size_t len;
+    };
+
+    // Glob pattern, compiled once and matched against many strings.
+    // '*' matches any sequence, '?' matches any char but '.'. Matching is O(pattern*str) worst case.
+    // static const wire::pattern logs( "*.log" ); logs.matches( "today.log" ) -> true
+
+    class pattern
+    {
+        public:
+
+        explicit pattern( const std::string &glob ) : glob( glob )
+        {
+            // literal segments in between stars; first and last ones are anchored
+            for( size_t pos = 0, star; ; pos = star + 1 ) {
+                star = glob.find( '*', pos );
+                segment seg = { pos, ( star == std::string::npos ? glob.size() : star ) - pos, false };
+                seg.wild = std::memchr( glob.data() + seg.pos, '?', seg.len ) != 0;
+                segments.push_back( seg );
+                if( star == std::string::npos ) break;
+            }
+        }
+
+        const std::string &str() const {
+            return glob;
+        }
+
+        bool matches( const string_view &str ) const {
+            return test( str.begin(), str.end(), false );
+        }
+
+        bool matchesi( const string_view &str ) const {
+            return test( str.begin(), str.end(), true );
+        }
+
+        private:
+
+        struct segment {
+            size_t pos, len;
+            bool wild; // has '?'
+        };
+
+        std::string glob;
+        std::vector< segment > segments;
+
+        bool equal( const segment &seg, const char *str, bool nocase ) const {
+            const char *p = glob.data() + seg.pos;
+            if( !seg.wild && !nocase ) return !std::memcmp( p, str, seg.len );
+            for( size_t i = 0; i < seg.len; ++i ) {
+                if( p[i] == '?' ? str[i] == '.' : ( p[i] != str[i] && ( !nocase || fold(p[i]) != fold(str[i]) ) ) ) return false;
+            }
+            return true;
+        }
+
+        // leftmost occurrence of seg within [begin,end), or null
+        const char *find( const segment &seg, const char *begin, const char *end, bool nocase ) const {
+            const char first = glob[ seg.pos ];
+            for( ; end - begin >= (ptrdiff_t)seg.len; ++begin ) {
+                if( !seg.wild && !nocase ) {
+                    begin = (const char *)std::memchr( begin, first, size_t( end - begin ) - seg.len + 1 );
+                    if( !begin ) return 0;
+                }
+                if( equal( seg, begin, nocase ) ) return begin;
+            }
+            return 0;
+        }
+
+        bool test( const char *begin, const char *end, bool nocase ) const {
+            const segment &front = segments.front(), &back = segments.back();
+            size_t len = size_t( end - begin );
+            if( segments.size() == 1 ) {
+                return len == front.len && equal( front, begin, nocase );
+            }
+            if( len < front.len + back.len ) return false;
+            if( !equal( front, begin, nocase ) || !equal( back, end - back.len, nocase ) ) return false;
+            begin += front.len, end -= back.len;
+            // leftmost match of every segment in between is always the best choice
+            for( size_t i = 1, last = segments.size() - 1; i < last; ++i ) {
+                if( !segments[i].len ) continue;
+                begin = find( segments[i], begin, end, nocase );
+                if( !begin ) return false;
+                begin += segments[i].len;
+            }
+            return true;
+        }
+    };
+
+    // Lazy tokenizer: yields the non-empty runs in between delimiters as views, without allocating.
+    // for( wire::string_view field : wire::tokens( line, ",;" ) ) ... The range must outlive its iterators.
+
+    class tokens
+    {
+        public:
+
+        class iterator
+        {
+            public:
+
+            typedef std::forward_iterator_tag iterator_category;
+            typedef string_view value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const string_view *pointer;
+            typedef const string_view &reference;
+
+            iterator()
+            {}
+
+            iterator( const charset *set, const char *begin, const char *end ) : scan( set, begin, end ), cur( begin, 0 )
+            {
+                ++*this;
+            }
+
+            reference operator*() const { return cur; }
+            pointer operator->() const { return &cur; }
+
+            iterator &operator++() {
+                const char *from = scan.next( cur.end(), false );
+                cur = string_view( from, size_t( scan.next( from, true ) - from ) );
+                return *this;
+            }
+
+            iterator operator++( int ) {
+                iterator it = *this;
+                return ++*this, it;
+            }
+
+            bool operator==( const iterator &other ) const { return cur.data() == other.cur.data() && cur.size() == other.cur.size(); }
+            bool operator!=( const iterator &other ) const { return !( *this == other ); }
+
+            private:
+
+            charset::cursor scan;
+            string_view cur;
+        };
+
+        tokens( const string_view &text, const string_view &delimiters ) : text( text ), set( delimiters.data(), delimiters.size() )
+        {}
+
+        tokens( const string_view &text, const charset &set ) : text( text ), set( set )
+        {}
+
+        iterator begin() const { return iterator( &set, text.begin(), text.end() ); }
+        iterator end() const { return iterator( &set, text.end(), text.end() ); }
+
+        size_t size() const {
+            size_t n = 0;
+            for( iterator it = begin(), e = end(); it != e; ++it ) n++;
+            return n;
+        }
+
+        private:
+
+        string_view text;
+        charset set;
+    };
+
+    // Lazy tokenizer that keeps separators: yields every run in between delimiters, then every delimiter as a 1-char view.
+    // for( wire::string_view token : wire::splits( "a+b", "+" ) ) -> "a", "+", "b"
+
+    class splits
+    {
+        public:
+
+        class iterator
+        {
+            public:
+
+            typedef std::forward_iterator_tag iterator_category;
+            typedef string_view value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const string_view *pointer;
+            typedef const string_view &reference;
+
+            iterator()
+            {}
+
+            iterator( const charset *set, const char *begin, const char *end ) : scan( set, begin, end ), cur( begin, 0 )
+            {
+                ++*this;
+            }
+
+            reference operator*() const { return cur; }
+            pointer operator->() const { return &cur; }
+
+            iterator &operator++() {
+                const char *from = cur.end();
+                cur = string_view( from, from == scan.last ? 0 : scan.set->has( *from ) ? 1 : size_t( scan.next( from, true ) - from ) );
+                return *this;
+            }
+
+            iterator operator++( int ) {
+                iterator it = *this;
+                return ++*this, it;
+            }
+
+            bool operator==( const iterator &other ) const { return cur.data() == other.cur.data() && cur.size() == other.cur.size(); }
+            bool operator!=( const iterator &other ) const { return !( *this == other ); }
+
+            private:
+
+            charset::cursor scan;
+            string_view cur;
+        };
+
+        splits( const string_view &text, const string_view &delimiters ) : text( text ), set( delimiters.data(), delimiters.size() )
+        {}
+
+        splits( const string_view &text, const charset &set ) : text( text ), set( set )
+        {}
+
+        iterator begin() const { return iterator( &set, text.begin(), text.end() ); }
+        iterator end() const { return iterator( &set, text.end(), text.end() ); }
+
+        size_t size() const {
+            size_t n = 0;
+            for( iterator it = begin(), e = end(); it != e; ++it ) n++;
+            return n;
+        }
+
+        private:
+
+        string_view text;
+        charset set;
+    };
+
+    inline wire::tokens string_view::tokens( const string_view &delimiters ) const {
+        return wire::tokens( *this, delimiters );
+    }
+
+    inline wire::splits string_view::splits( const string_view &delimiters ) const {
+        return wire::splits( *this, delimiters );
+    }
+
+    inline std::deque< string_view > string_view::tokenize( const string_view &delimiters ) const {
+        wire$probe( tokenize );
+        std::deque< string_view > out;
+        for( const string_view &token : wire::tokens( *this, delimiters ) ) out.push_back( token );
+        return out;
+    }
+
+    inline std::deque< string_view > string_view::split( const string_view &delimiters ) const {
+        wire$probe( split );
+        std::deque< string_view > out;
+        for( const string_view &token : wire::splits( *this, delimiters ) ) out.push_back( token );
+        return out;
+    }
+
+    // Multi-target replacement table, compiled once from a map into a trie.
+    // Input is scanned in one pass; the longest target wins at every position, and unmatched runs are copied in bulk.
+    // static const wire::replacer html( entities ); html( text ) or wire::string( text ).replace_map( html )
+
+    class replacer
+    {
+        public:
+
+        explicit replacer( const std::map< std::string, std::string > &replacements )
+        {
+            // build a temporary trie, then flatten it: root is a direct table, other nodes keep sorted edges
+            struct tmp { int value; std::map< unsigned char, unsigned > next; };
+            std::vector< tmp > trie( 1 );
+            trie[0].value = -1;
+            for( std::map< std::string, std::string >::const_iterator it = replacements.begin(); it != replacements.end(); ++it ) {
+                if( it->first.empty() ) continue;
+                unsigned n = 0;
+                for( const char &ch : it->first ) {
+                    std::map< unsigned char, unsigned >::iterator found = trie[n].next.find( (unsigned char)ch );
+                    if( found == trie[n].next.end() ) {
+                        trie.push_back( tmp() );
+                        trie.back().value = -1;
+                        found = trie[n].next.insert( std::make_pair( (unsigned char)ch, unsigned( trie.size() - 1 ) ) ).first;
+                    }
+                    n = found->second;
+                }
+                trie[n].value = int( values.size() );
+                values.push_back( it->second );
+            }
+
+            nodes.resize( trie.size() );
+            for( size_t n = 0; n < trie.size(); ++n ) {
+                nodes[n].value = trie[n].value;
+                nodes[n].first = unsigned( edges.size() );
+                nodes[n].count = unsigned( trie[n].next.size() );
+                for( std::map< unsigned char, unsigned >::const_iterator it = trie[n].next.begin(); it != trie[n].next.end(); ++it ) {
+                    edge e = { it->first, it->second };
+                    edges.push_back( e );
+                }
+            }
+            for( unsigned i = 0; i < 256; ++i ) root[i] = 0;
+            for( unsigned i = nodes[0].first, e = i + nodes[0].count; i < e; ++i ) root[ edges[i].ch ] = edges[i].next;
+        }
+
+        // Appends replaced input to out
+        template< typename S >
+        S &append( S &out, const string_view &in ) const
+        {
+            const char *it = in.begin(), *end = in.end(), *run = it;
+            while( it < end ) {
+                unsigned n = root[ (unsigned char)*it ];
+                if( !n ) {
+                    ++it;
+                    continue;
+                }
+                // walk the trie as far as possible, remember longest target
+                int value = nodes[n].value;
+                const char *match = it + 1, *walk = it + 1;
+                while( walk < end && ( n = child( n, (unsigned char)*walk ) ) != 0 ) {
+                    ++walk;
+                    if( nodes[n].value >= 0 ) value = nodes[n].value, match = walk;
+                }
+                if( value < 0 ) {
+                    ++it;
+                    continue;
+                }
+                out.append( run, it );
+                out.append( values[ value ].data(), values[ value ].size() );
+                run = it = match;
+            }
+            return out.append( run, end ), out;
+        }
+
+        std::string operator()( const string_view &in ) const
+        {
+            std::string out;
+            out.reserve( in.size() );
+            return append( out, in ), out;
+        }
+
+        private:
+
+        struct node {
+            int value; // replacement index, or -1
+            unsigned first, count; // edges
+        };
+        struct edge {
+            unsigned char ch;
+            unsigned next;
+        };
+
+        unsigned root[ 256 ];
+        std::vector< node > nodes;
+        std::vector< edge > edges;
+        std::vector< std::string > values;
+
+        unsigned child( unsigned n, unsigned char ch ) const
+        {
+            const edge *lo = edges.data() + nodes[n].first, *hi = lo + nodes[n].count;
+            while( lo < hi ) {
+                const edge *mid = lo + ( hi - lo ) / 2;
+                if( mid->ch < ch ) lo = mid + 1;
+                else if( mid->ch > ch ) hi = mid;
+                else return mid->next;
+            }
+            return 0;
+        }
+    };
+
+    inline bool string_view::matches( const wire::pattern &pattern ) const {
+        return pattern.matches( *this );
+    }
+
+    inline bool string_view::matchesi( const wire::pattern &pattern ) const {
+        return pattern.matchesi( *this );
+    }
+
+    namespace
+    {
+        template<>
+        inline string_view as( const char *begin, const char *end ) {
+            return string_view( begin, size_t( end - begin ) );
+        }
+        template<>
+        inline string_view as( const std::string &self ) {
+            return string_view( self );
+        }
+
+        // An argument rendered without temporaries: strings are referenced, numbers are formatted inline
+
+        // streambuf appending straight into a std::string
+        struct string_buffer : public std::streambuf {
+            std::string *out;
+
+            string_buffer() : out( 0 )
+            {}
+
+            int_type overflow( int_type c ) {
+                if( !traits_type::eq_int_type( c, traits_type::eof() ) ) out->push_back( traits_type::to_char_type( c ) );
+                return traits_type::not_eof( c );
+            }
+            std::streamsize xsputn( const char *s, std::streamsize n ) {
+                out->append( s, size_t( n ) );
+                return n;
+            }
+        };
+
+        // streams are costly to build: one per thread, reset before each use. Nested uses
+        // (an operator<< that formats wire strings itself) get a fresh stream instead.
+        struct shared_stream {
+            string_buffer buffer;
+            std::ostream os;
+            bool busy;
+
+            shared_stream() : os( &buffer ), busy( false )
+            {}
+        };
+
+        inline shared_stream &thread_stream() {
+            static thread_local shared_stream shared;
+            return shared;
+        }
+
+        // any std::basic_string<char> (or derived), whatever its allocator, string_view (or derived) or
+        // small_string: decltype( is_string( (const T *)0 ) ). Defined only to keep -Wunused-function quiet
+        template< typename A >
+        std::true_type is_string( const std::basic_string< char, std::char_traits< char >, A > * );
+        inline std::true_type is_string( const string_view * ) { return std::true_type(); }
+        template< size_t N >
+        std::true_type is_string( const small_string< N > * );
+        inline std::false_type is_string( ... ) { return std::false_type(); }
+
+        struct piece {
+            const char *ptr;
+            size_t len;
+            char buf[ 64 ];
+            std::string heap;
+
+            piece() : ptr( buf ), len( 0 )
+            {}
+
+            piece( const piece & ) = delete;
+            piece &operator=( const piece & ) = delete;
+
+            void set( const std::string &t )        { ptr = t.data(); len = t.size(); }
+            void set( const string_view &t )        { ptr = t.data(); len = t.size(); }
+            void set( const char *t )               { ptr = t ? t : ""; len = std::strlen( ptr ); }
+            void set( char * const &t )             { set( (const char *)t ); }
+            void set( const char &t )               { buf[0] = t; ptr = buf; len = 1; }
+            void set( const signed char &t )        { set( char(t) ); }
+            void set( const unsigned char &t )      { set( char(t) ); }
+            void set( const bool &t )               { ptr = t ? "true" : "false"; len = t ? 4 : 5; }
+
+            void set( const short &t )              { set_integer( t ); }
+            void set( const unsigned short &t )     { set_integer( t ); }
+            void set( const int &t )                { set_integer( t ); }
+            void set( const unsigned int &t )       { set_integer( t ); }
+            void set( const long &t )               { set_integer( t ); }
+            void set( const unsigned long &t )      { set_integer( t ); }
+            void set( const long long &t )          { set_integer( t ); }
+            void set( const unsigned long long &t ) { set_integer( t ); }
+
+            void set( const float &t )              { ptr = buf; len = format_real( buf, t ); }
+            void set( const double &t )             { ptr = buf; len = format_real( buf, t ); }
+            void set( const long double &t )        { ptr = buf; len = format_real( buf, t ); }
+
+            template< typename T >
+            void set( const T &t ) {
+                set_any( t, decltype( is_string( (const T *)0 ) )() );
+            }
+
+            private:
+
+            template< typename T >
+            void set_integer( const T &t ) {
+                char *end = buf + sizeof(buf);
+                ptr = format_integer( end, t );
+                len = size_t( end - ptr );
+            }
+
+            template< typename T >
+            void set_any( const T &t, std::true_type /*is a string*/ ) {
+                ptr = t.data(), len = t.size();
+            }
+
+            template< typename T >
+            void set_any( const T &t, std::false_type ) {
+                shared_stream &shared = thread_stream();
+                if( shared.busy ) {
+                    std::stringstream ss;
+                    if( ss << t ) heap = ss.str();
+                } else {
+                    struct lease {
+                        shared_stream &s;
+                        lease( shared_stream &shared, std::string &out ) : s( shared ) {
+                            s.busy = true, s.buffer.out = &out;
+                            s.os.clear(), s.os.flags( std::ios_base::skipws | std::ios_base::dec );
+                            s.os.precision( 6 ), s.os.width( 0 ), s.os.fill( ' ' );
+                        }
+                        ~lease() { s.busy = false; }
+                    } in_use( shared, heap );
+                    if( !( shared.os << t ) ) heap.clear();
+                }
+                ptr = heap.data();
+                len = heap.size();
+            }
+        };
+
+        inline void bind( piece * )
+        {}
+
+        template< typename T, typename... Ts >
+        inline void bind( piece *p, const T &t, const Ts &... ts ) {
+            p->set( t );
+            bind( p + 1, ts... );
+        }
+
+        // same allocator template, any value_type (eg, the rebound allocator of a container of strings)
+        template< typename A, typename B >
+        struct same_allocator : std::false_type {};
+
+        template< template< typename > class X, typename U, typename V >
+        struct same_allocator< X< U >, X< V > > : std::true_type {};
+
+        // a lone trailing allocator, or pointer convertible to one (eg, std::pmr::memory_resource *),
+        // selects the allocator constructors rather than being formatted
+        template< typename Alloc, typename... Ts >
+        struct format_args : std::true_type {};
+
+        template< typename Alloc, typename T >
+        struct format_args< Alloc, T > : std::integral_constant< bool, !same_allocator< T, Alloc >::value &&
+            !( std::is_pointer< T >::value && std::is_convertible< T, Alloc >::value ) > {};
+
+        template< typename S >
+        inline bool aliased( const piece *pieces, unsigned N, const S &out ) {
+            const char *begin = out.data(), *end = begin + out.capacity();
+            for( unsigned i = 0; i < N; ++i )
+                if( pieces[i].ptr >= begin && pieces[i].ptr < end ) return true;
+            return false;
+        }
+
+        // Argument escapes: \1..\7 for 1st..7th argument, or \x10 followed by the argument number (1..255).
+        // Decodes fmt[i], returns argument number (0 if literal) and its width in bytes.
+        inline unsigned slot_at( const char *fmt, size_t len, size_t i, size_t &width ) {
+            unsigned char ch = (unsigned char)( fmt[i] );
+            width = 1;
+            if( ch >= 1 && ch <= 7 ) return ch;
+            if( ch == 0x10 && i + 1 < len && fmt[i + 1] ) return width = 2, (unsigned char)( fmt[i + 1] );
+            return 0;
+        }
+
+        // Safe formatting of fmt into out: measures, reserves once, then writes every run in place.
+        template< typename S >
+        inline S &format_pieces( S &out, const char *fmt, size_t len, const piece *pieces, unsigned N ) {
+            if( aliased( pieces, N, out ) || ( fmt >= out.data() && fmt < out.data() + out.capacity() ) ) {
+                S tmp( out.get_allocator() );
+                return out.append( format_pieces( tmp, fmt, len, pieces, N ) ), out;
+            }
+
+            size_t total = 0, width;
+            for( size_t i = 0; i < len; i += width ) {
+                unsigned slot = slot_at( fmt, len, i, width );
+                total += slot && slot <= N ? pieces[ slot - 1 ].len : width;
+            }
+            out.reserve( out.size() + total );
+
+            size_t run = 0;
+            for( size_t i = 0; i < len; i += width ) {
+                unsigned slot = slot_at( fmt, len, i, width );
+                if( slot && slot <= N ) {
+                    out.append( fmt + run, i - run );
+                    out.append( pieces[ slot - 1 ].ptr, pieces[ slot - 1 ].len );
+                    run = i + width;
+                }
+            }
+            return out.append( fmt + run, len - run ), out;
+        }
+
+        template< typename S, typename... Ts >
+        inline S &format_safe( S &out, const char *fmt, size_t len, const Ts &... ts ) {
+            enum { N = sizeof...(Ts) };
+            piece pieces[ N + 1 ];
+            bind( pieces, ts... );
+            return format_pieces( out, fmt, len, pieces, N );
+        }
+    }
+
+    // Safe format, parsed once. Bytes \1..\7 are replaced by 1st..7th argument; \x10 followed by byte N (1..255)
+    // is replaced by Nth argument (see fmt::slot()); any other byte is copied as is.
+    // Keep it around (i.e. static) so the parsing is amortized across calls:
+    // static const wire::fmt kv( "\1=\2;" ); kv( "health", 100 ) -> "health=100;"
+
+    class fmt
+    {
+        public:
+
+        fmt( const std::string &format ) : source( format ), literals( 0 )
+        {
+            for( size_t i = 0, len = source.size(), width; i < len; i += width ) {
+                unsigned slot = slot_at( source.data(), len, i, width );
+                if( slot ) {
+                    spans.push_back( span( i, width, slot ) );
+                } else if( spans.empty() || spans.back().slot ) {
+                    spans.push_back( span( i, 1, 0 ) ), ++literals;
+                } else {
+                    spans.back().len++, ++literals;
+                }
+            }
+        }
+
+        const std::string &str() const {
+            return source;
+        }
+
+        // Escape sequence for Nth argument (1..255, clamped): fmt::slot(12) -> "\x10\x0c"
+        static std::string slot( unsigned n ) {
+            n = n < 1 ? 1 : n > 255 ? 255 : n;
+            return n <= 7 ? std::string( 1, char(n) ) : std::string( "\x10" ) + char(n);
+        }
+
+        // Output size for N arguments of the given lengths
+        size_t size( const size_t *lengths, unsigned N ) const {
+            size_t total = literals;
+            for( const span &s : spans )
+                if( s.slot ) total += s.slot <= N ? lengths[ s.slot - 1 ] : s.len;
+            return total;
+        }
+
+        // Appends formatted output to out. Exact output size is reserved upfront.
+        template< typename S, typename... Ts >
+        S &append( S &out, const Ts &... ts ) const {
+            enum { N = sizeof...(Ts) };
+            piece pieces[ N + 1 ];
+            bind( pieces, ts... );
+
+            size_t total = literals;
+            bool aliased = false;
+            for( const span &s : spans ) {
+                if( s.slot && s.slot <= N ) {
+                    const piece &p = pieces[ s.slot - 1 ];
+                    total += p.len;
+                    aliased |= p.ptr >= out.data() && p.ptr < out.data() + out.capacity();
+                } else if( s.slot ) {
+                    total += s.len;
+                }
+            }
+
+            if( aliased ) {
+                S tmp( out.get_allocator() );
+                return out.append( append( tmp, ts... ) ), out;
+            }
+
+            out.reserve( out.size() + total );
+            for( const span &s : spans ) {
+                if( s.slot && s.slot <= N ) out.append( pieces[ s.slot - 1 ].ptr, pieces[ s.slot - 1 ].len );
+                else out.append( source.data() + s.pos, s.len );
+            }
+            return out;
+        }
+
+        template< typename... Ts >
+        std::string operator()( const Ts &... ts ) const {
+            std::string out;
+            return append( out, ts... ), out;
+        }
+
+        private:
+
+        struct span {
+            size_t pos, len;
+            unsigned slot; // 0 for literals, else argument number
+            span( size_t pos, size_t len, unsigned slot ) : pos( pos ), len( len ), slot( slot )
+            {}
+        };
+
+        std::string source;
+        std::vector< span > spans;
+        size_t literals;
+    };
+
+    template< typename Alloc >
+    class basic_string : public std::basic_string< char, std::char_traits< char >, Alloc >
+    {
+        typedef std::basic_string< char, std::char_traits< char >, Alloc > base;
+
+        public:
+
+        typedef Alloc allocator_type;
+        typedef std::deque< basic_string, typename std::allocator_traits< Alloc >::template rebind_alloc< basic_string > > list_type;
+
+        // basic constructors
+
+        basic_string() : base()
+        {}
+
+        // allocator-aware constructors. Extended methods allocate their results with the allocator of the source string
+
+        explicit basic_string( const Alloc &alloc ) : base( alloc )
+        {}
+
+        basic_string( const char *cstr, const Alloc &alloc ) : base( cstr ? cstr : "", alloc )
+        {}
+
+        basic_string( const string_view &v, const Alloc &alloc ) : base( v.data(), v.size(), alloc )
+        {}
+
+        basic_string( const base &s, const Alloc &alloc ) : base( s, alloc )
+        {}
+
+        // also take rebound allocators, as passed by allocator-aware containers of wire strings
+        template< typename A, typename = typename std::enable_if< same_allocator< A, Alloc >::value >::type >
+        basic_string( const basic_string &s, const A &alloc ) : base( s, Alloc( alloc ) )
+        {}
+
+        template< typename A, typename = typename std::enable_if< same_allocator< A, Alloc >::value >::type >
+        basic_string( basic_string &&s, const A &alloc ) : base( std::move( s ), Alloc( alloc ) )
+        {}
+
+        // copies and moves; std::string rvalues hand over their buffer as well
+
+        basic_string( const basic_string & ) = default;
+        basic_string( basic_string && ) = default;
+        basic_string &operator=( const basic_string & ) = default;
+        basic_string &operator=( basic_string && ) = default;
+
+        basic_string( const base &s ) : base( s )
+        {}
+
+        basic_string( base &&s ) : base( std::move( s ) )
+        {}
+
+        basic_string &operator=( base &&s )
+        {
+            base::operator=( std::move( s ) );
+            return *this;
+        }
+
+        template< typename A >
+        basic_string( const std::basic_string< char, std::char_traits< char >, A > &s ) : base( s.data(), s.size() )
+        {}
+
+        basic_string( const string_view &v ) : base( v.data(), v.size() )
+        {}
+
+        basic_string( const char &c ) : base( 1, c )
+        {}
+
+        basic_string( const char &c, size_t n ) : base( n, c )
+        {}
+
+        basic_string( size_t n, const char &c ) : base( n, c )
+        {}
+
+        basic_string( const char *cstr ) : base( cstr ? cstr : "" )
+        {}
+
+        basic_string( char * const &cstr ) : base( cstr ? cstr : "" )
+        {}
+
+        template<size_t N>
+        basic_string( const char (&cstr)[N] ) : base( cstr )
+        {}
+
+        basic_string( const bool &val ) : base( val ? "true" : "false" )
+        {}
+
+        // constructor sugars; strings of any allocator are copied as is, other types go through a stringstream
+
+        template< typename T >
+        basic_string( const T &t ) : base()
+        {
+            wire$probe_on( construct, *this );
+            piece p;
+            p.set( t );
+            this->assign( p.ptr, p.len );
+        }
+
+        // numeric constructors; locale-free
+
+        basic_string( const short &t )              : base() { assign_integer( t ); }
+        basic_string( const unsigned short &t )     : base() { assign_integer( t ); }
+        basic_string( const int &t )                : base() { assign_integer( t ); }
+        basic_string( const unsigned int &t )       : base() { assign_integer( t ); }
+        basic_string( const long &t )               : base() { assign_integer( t ); }
+        basic_string( const unsigned long &t )      : base() { assign_integer( t ); }
+        basic_string( const long long &t )          : base() { assign_integer( t ); }
+        basic_string( const unsigned long long &t ) : base() { assign_integer( t ); }
+
+        // reals render the shortest round-trip representation (see WIRE_COMPAT_PRECISION)
+
+        basic_string( const float &t ) : base()
+        {
+            wire$probe_on( construct, *this );
+            char buf[ 64 ];
+            this->assign( buf, format_real( buf, t ) );
+        }
+
+        basic_string( const double &t ) : base()
+        {
+            wire$probe_on( construct, *this );
+            char buf[ 64 ];
+            this->assign( buf, format_real( buf, t ) );
+        }
+
+        basic_string( const long double &t ) : base()
+        {
+            wire$probe_on( construct, *this );
+            char buf[ 64 ];
+            this->assign( buf, format_real( buf, t ) );
+        }
+
+        private:
+        template< typename T >
+        void assign_integer( const T &t )
+        {
+            wire$probe_on( construct, *this );
+            char buf[ 24 ], *end = buf + sizeof(buf);
+            char *begin = format_integer( end, t );
+            this->assign( begin, size_t( end - begin ) );
+        }
+        public:
+
+        // extended constructors; safe formatting (see wire::fmt for escapes)
+
+        template< typename... Ts, typename = typename std::enable_if< format_args< Alloc, Ts... >::value >::type >
+        basic_string( const char *fmt, const Ts &... ts ) : base()
+        {
+            wire$probe_on( format, *this );
+            format_safe( *this, fmt ? fmt : "", fmt ? std::strlen( fmt ) : 0, ts... );
+        }
+
+        template< typename... Ts, typename = typename std::enable_if< format_args< Alloc, Ts... >::value >::type >
+        basic_string( const base &fmt, const Ts &... ts ) : base()
+        {
+            wire$probe_on( format, *this );
+            format_safe( *this, fmt.data(), fmt.size(), ts... );
+        }
+
+        // extended constructors; safe formatting with a preparsed wire::fmt
+
+        template< typename... Ts >
+        basic_string( const wire::fmt &f, const Ts &... ts ) : base()
+        {
+            wire$probe_on( format, *this );
+            f.append( *this, ts... );
+        }
+
+        basic_string &operator()() & {
+            return *this;
+        }
+
+        basic_string operator()() && {
+            return std::move( *this );
+        }
+
+        // formats in place; *this is the format and the result. Temporaries are formatted in place and moved out
+        template< typename... Ts >
+        basic_string operator()( const Ts &... ts ) && {
+            return std::move( (*this)( ts... ) );
+        }
+
+        template< typename... Ts >
+        basic_string &operator()( const Ts &... ts ) & {
+            wire$probe_on( format, *this );
+            enum { N = sizeof...(Ts) };
+            piece pieces[ N + 1 ];
+            bind( pieces, ts... );
+            if( aliased( pieces, N, *this ) ) {
+                basic_string out( this->get_allocator() );
+                format_pieces( out, this->data(), this->size(), pieces, N );
+                this->swap( out );
+                return *this;
+            }
+            // keep our own capacity: format from a copy (on the stack unless long, freed on return), output into *this
+            char stack[ 256 ];
+            std::string heap;
+            size_t len = this->size();
+            char *copy = len <= sizeof(stack) ? stack : ( heap.assign( this->data(), len ), &heap[0] );
+            if( copy == stack && len ) std::memcpy( stack, this->data(), len );
+            this->clear();
+            format_pieces( *this, copy, len, pieces, N );
+            return *this;
+        }
+
+        // conversion
+
+        template< typename T >
+        T as() const
+        {
+            wire$probe( as );
+            return convert( (T *)0 );
+        }
+
+        template< typename T >
+        bool try_as( T &t ) const
+        {
+            wire$probe( as );
+            return parse( this->data(), this->data() + this->size(), t );
+        }
+
+        template< typename T >
+        operator T() const
+        {
+            wire$probe( as );
+            return convert( (T *)0 );
+        }
+
+        private:
+        template< typename T >
+        T convert( T * ) const
+        {
+            return wire::as<T>( this->data(), this->data() + this->size() );
+        }
+        const char *convert( const char ** ) const
+        {
+            return this->c_str();
+        }
+        public:
+
+        // chaining operators
+
+        template <typename T>
+        basic_string &operator <<( const T &t )
+        {
+            piece p;
+            p.set( t );
+            this->append( p.ptr, p.len );
+            return *this;
+        }
+
+        // pre-sizes *this for extra more bytes, growing geometrically: s.reserve_hint( 64 ) << "id=" << id << ...
+        basic_string &reserve_hint( size_t extra )
+        {
+            size_t wanted = this->size() + extra;
+            if( wanted > this->capacity() ) this->reserve( std::max( wanted, this->capacity() * 2 ) );
+            return *this;
+        }
+
+        // rvalue strings: taken over when *this is empty, or prepended to when only theirs has room for both
+        basic_string &operator <<( basic_string &&s )
+        {
+            return append_moved( s );
+        }
+
+        basic_string &operator <<( base &&s )
+        {
+            return append_moved( s );
+        }
+
+        basic_string &operator <<( std::ostream &( *pf )(std::ostream &) )
+        {
+            return *pf == static_cast<std::ostream& ( * )(std::ostream&)>( std::endl ) ? (*this) += "\n", *this : *this;
+        }
+
+        template< typename T >
+        basic_string &operator +=( const T &t )
+        {
+            return operator<<(t);
+        }
+
+        basic_string &operator +=( basic_string &&s )
+        {
+            return append_moved( s );
+        }
+
+        basic_string &operator +=( base &&s )
+        {
+            return append_moved( s );
+        }
+
+        basic_string &operator +=( std::ostream &( *pf )(std::ostream &) )
+        {
+            return operator<<(pf);
+        }
+
+        private:
+        basic_string &append_moved( base &s )
+        {
+            size_t total = this->size() + s.size();
+            if( this->empty() )
+                base::operator=( std::move( s ) );
+            else if( total > this->capacity() && total <= s.capacity() && this->get_allocator() == s.get_allocator() )
+                s.insert( 0, *this ), this->swap( s );
+            else
+                this->append( s );
+            return *this;
+        }
+        public:
+
+        // assignment sugars; reuse the current capacity
+
+        template< typename T >
+        basic_string &operator=( const T &t )
+        {
+            piece p;
+            p.set( t );
+            this->assign( p.ptr, p.len );
+            return *this;
+        }
+
+        // comparison sugars
+/*
+        operator const bool() const
+        {
+            return wire::as<bool>(*this);
+        }
+*/
+        // strings of any allocator compare bytes; anything else compares as a T parsed out of both sides
+        template<typename T>
+        bool operator ==( const T &t ) const
+        {
+            return equals( t, decltype( is_string( (const T *)0 ) )() );
+        }
+        bool operator ==( const basic_string &t ) const
+        {
+            return this->compare( t ) == 0;
+        }
+        bool operator ==( const string_view &t ) const
+        {
+            return view() == t;
+        }
+        bool operator ==( const char *t ) const
+        {
+            return this->compare( t ) == 0;
+        }
+
+        private:
+        template< typename T >
+        bool equals( const T &t, std::true_type /*is a string*/ ) const
+        {
+            return view() == string_view( t.data(), t.size() );
+        }
+        template< typename T >
+        bool equals( const T &t, std::false_type ) const
+        {
+            return this->template as<T>() == basic_string(t).template as<T>();
+        }
+        public:
+
+        // extra methods
+
+        // at() classic behaviour: "hello"[5] = undefined, "hello"[-1] = undefined
+        // at() extended behaviour: "hello"[5] = h, "hello"[-1] = o,
+
+        // at() never throws: empty strings return a reference to a per-thread '\0' scratch char instead
+
+        const char &at( const int &pos ) const
+        {
+            signed size = (signed)(this->size());
+            if( unsigned(pos) < unsigned(size) )
+                return this->base::operator[]( pos );
+            if( size )
+                return this->base::operator[]( pos >= 0 ? pos % size : size - 1 + ((pos+1) % size) );
+            return sentinel();
+        }
+
+        char &at( const int &pos )
+        {
+            signed size = (signed)(this->size());
+            if( unsigned(pos) < unsigned(size) )
+                return this->base::operator[]( pos );
+            if( size )
+                return this->base::operator[]( pos >= 0 ? pos % size : size - 1 + ((pos+1) % size) );
+            return sentinel();
+        }
+
+        // at_unchecked(): classic unchecked access, pos must be in [0, size())
+
+        const char &at_unchecked( size_t pos ) const
+        {
+            return this->base::operator[]( pos );
+        }
+
+        char &at_unchecked( size_t pos )
+        {
+            return this->base::operator[]( pos );
+        }
+
+        private:
+        static char &sentinel()
+        {
+            static thread_local char ch;
+            return ch = '\0';
+        }
+        public:
+
+        const char &operator[]( const int &pos ) const {
+            return this->at(pos);
+        }
+        char &operator[]( const int &pos ) {
+            return this->at(pos);
+        }
+
+        void pop_back()
+        {
+            if( this->size() )
+                this->erase( this->end() - 1 );
+        }
+
+        void pop_front()
+        {
+            if( this->size() )
+                this->erase( 0, 1 ); //this->substr( 1 ); //this->assign( this->begin() + 1, this->end() );
+        }
+
+        // push_back()/push_front() work in place; other types than chars and strings are formatted on the stack
+
+        template<typename T>
+        void push_back( const T& t ) {
+            wire$probe_on( push, *this );
+            piece p;
+            p.set( t );
+            this->append( p.ptr, p.len );
+        }
+        void push_back( const char &ch ) {
+            wire$probe_on( push, *this );
+            this->base::push_back( ch );
+        }
+        void push_back( const char *cstr ) {
+            wire$probe_on( push, *this );
+            if( cstr ) this->append( cstr );
+        }
+        void push_back( const base &str ) {
+            wire$probe_on( push, *this );
+            this->append( str );
+        }
+
+        template<typename T>
+        void push_front( const T& t ) {
+            wire$probe_on( push, *this );
+            piece p;
+            p.set( t );
+            this->insert( 0, p.ptr, p.len );
+        }
+        void push_front( const char &ch ) {
+            wire$probe_on( push, *this );
+            this->insert( this->begin(), ch );
+        }
+        void push_front( const char *cstr ) {
+            wire$probe_on( push, *this );
+            if( cstr ) this->insert( 0, cstr );
+        }
+        void push_front( const base &str ) {
+            wire$probe_on( push, *this );
+            this->insert( 0, str );
+        }
+
+        const char &back() const
+        {
+            return at(-1);
+        }
+
+        char &back()
+        {
+            return at(-1);
+        }
+
+        const char &front() const
+        {
+            return at(0);
+        }
+
+        char &front()
+        {
+            return at(0);
+        }
+
+        // tools
+
+        // non-owning view over this string; valid until this string is modified or destroyed
+        string_view view() const
+        {
+            return string_view( this->data(), this->size() );
+        }
+
+        std::string str( const std::string &pre = std::string(), const std::string &post = std::string() ) const
+        {
+            return view().str( pre, post );
+        }
+
+        // case mapping is ASCII only
+
+        basic_string uppercase() const &
+        {
+            basic_string s( *this, this->get_allocator() );
+            s.to_upper();
+            return s;
+        }
+
+        basic_string uppercase() &&
+        {
+            return std::move( to_upper() );
+        }
+
+        basic_string lowercase() const &
+        {
+            basic_string s( *this, this->get_allocator() );
+            s.to_lower();
+            return s;
+        }
+
+        basic_string lowercase() &&
+        {
+            return std::move( to_lower() );
+        }
+
+        basic_string &to_upper()
+        {
+            if( !this->empty() ) ascii_case( &at_unchecked(0), this->size(), true );
+            return *this;
+        }
+
+        basic_string &to_lower()
+        {
+            if( !this->empty() ) ascii_case( &at_unchecked(0), this->size(), false );
+            return *this;
+        }
+
+        bool matches( const base &pattern ) const
+        {
+            return view().matches( pattern );
+        }
+
+        bool matchesi( const base &pattern ) const
+        {
+            return view().matchesi( pattern );
+        }
+
+        bool matches( const wire::pattern &pattern ) const
+        {
+            return pattern.matches( view() );
+        }
+
+        bool matchesi( const wire::pattern &pattern ) const
+        {
+            return pattern.matchesi( view() );
+        }
+
+        size_t count( const base &substr, search hint = search::automatic ) const
+        {
+            return view().count( substr, hint );
+        }
+
+        basic_string left_of( const base &substring ) const
+        {
+            size_t pos = view().find( substring );
+            return basic_string( pos == string_view::npos ? view() : view().substr( 0, pos ), this->get_allocator() );
+        }
+
+        basic_string right_of( const base &substring ) const
+        {
+            size_t pos = view().find( substring );
+            return basic_string( pos == string_view::npos ? view() : view().substr( pos + 1 ), this->get_allocator() );
+        }
+
+        // replace1()/replace() build the result out of place with a single, exactly sized allocation;
+        // on temporaries they work in place instead (see replace_inplace()). Empty targets never match.
+        basic_string replace1( const base &target, const base &replacement, search hint = search::automatic ) const & {
+            wire$probe( replace );
+            const char *begin = this->data(), *end = begin + this->size();
+            const char *found = target.empty() ? 0 : finder( target.data(), target.size(), hint ).find( begin, end );
+            basic_string out( this->get_allocator() );
+            if( !found ) out.assign( *this );
+            else {
+                out.reserve( this->size() - target.size() + replacement.size() );
+                out.append( begin, found ).append( replacement ).append( found + target.size(), end );
+            }
+            wire$probe_result( out );
+            return out;
+        }
+
+        basic_string replace1( const base &target, const base &replacement, search hint = search::automatic ) && {
+            wire$probe_on( replace, *this );
+            const char *begin = this->data(), *end = begin + this->size();
+            const char *found = target.empty() ? 0 : finder( target.data(), target.size(), hint ).find( begin, end );
+            if( found ) this->base::replace( size_t( found - begin ), target.size(), replacement );
+            return std::move( *this );
+        }
+
+        basic_string replace( const base &target, const base &replacement, search hint = search::automatic ) const &
+        {
+            wire$probe( replace );
+            basic_string out( this->get_allocator() );
+            size_t n = 0;
+            if( !target.empty() ) {
+                finder f( target.data(), target.size(), hint );
+                const char *p = this->data(), *end = p + this->size(), *found;
+                for( const char *q = p; ( q = f.find( q, end ) ); q += target.size() ) n++;
+                if( n ) {
+                    out.reserve( this->size() - n * target.size() + n * replacement.size() );
+                    for( ; ( found = f.find( p, end ) ); p = found + target.size() )
+                        out.append( p, found ).append( replacement );
+                    out.append( p, end );
+                }
+            }
+            if( !n ) out.assign( *this );
+            wire$probe_result( out );
+            return out;
+        }
+
+        basic_string replace( const base &target, const base &replacement, search hint = search::automatic ) &&
+        {
+            return std::move( replace_inplace( target, replacement, hint ) );
+        }
+
+        // replace_inplace(): no allocation when the replacement is not longer than the target;
+        // longer replacements are built out of place (one allocation) and swapped in.
+        basic_string &replace_inplace( const base &target, const base &replacement, search hint = search::automatic )
+        {
+            if( target.empty() || this->empty() ) return *this;
+            if( replacement.size() > target.size() ) {
+                basic_string out = replace( target, replacement, hint );
+                this->swap( out );
+                return *this;
+            }
+            wire$probe( replace ); // longer replacements are counted by replace()
+            finder f( target.data(), target.size(), hint );
+            char *begin = &this->base::operator[]( 0 ), *w = begin;
+            const char *p = begin, *end = begin + this->size(), *found;
+            for( ; ( found = f.find( p, end ) ); p = found + target.size() ) {
+                if( replacement.size() == target.size() ) {
+                    std::memcpy( (char *)found, replacement.data(), replacement.size() );
+                    continue;
+                }
+                std::memmove( w, p, found - p ), w += found - p;
+                std::memcpy( w, replacement.data(), replacement.size() ), w += replacement.size();
+            }
+            if( replacement.size() != target.size() ) {
+                std::memmove( w, p, end - p ), w += end - p;
+                this->resize( w - begin );
+            }
+            return *this;
+        }
+
+        // replace_map(): longest target wins at every position. Compile a wire::replacer once for repeated use.
+        basic_string replace_map( const std::map< std::string, std::string > &replacements ) const
+        {
+            return replace_map( wire::replacer( replacements ) );
+        }
+
+        basic_string replace_map( const wire::replacer &replacements ) const
+        {
+            wire$probe( replace );
+            basic_string out( this->get_allocator() );
+            out.reserve( this->size() );
+            replacements.append( out, view() );
+            wire$probe_result( out );
+            return out;
+        }
+
+        private:
+
+        basic_string strip( const base &chars, bool strip_left, bool strip_right ) const &
+        {
+            wire$probe( strip );
+            basic_string out( view().strip( chars, strip_left, strip_right ), this->get_allocator() );
+            wire$probe_result( out );
+            return out;
+        }
+
+        basic_string strip( const base &chars, bool strip_left, bool strip_right ) &&
+        {
+            wire$probe( strip );
+            string_view kept = view().strip( chars, strip_left, strip_right );
+            size_t from = kept.empty() ? 0 : size_t( kept.data() - this->data() );
+            this->erase( from + kept.size() ).erase( 0, from );
+            return std::move( *this );
+        }
+
+        public: // based on python string and pystring
+
+        // Return a copy of the string with leading characters removed (default chars: space)
+        basic_string lstrip( const base &chars = base() ) const &
+        {
+            return strip( chars, true, false );
+        }
+        basic_string lstrip( const base &chars = base() ) &&
+        {
+            return std::move( *this ).strip( chars, true, false );
+        }
+        basic_string ltrim( const base &chars = base() ) const &
+        {
+            return strip( chars, true, false );
+        }
+        basic_string ltrim( const base &chars = base() ) &&
+        {
+            return std::move( *this ).strip( chars, true, false );
+        }
+
+        // Return a copy of the string with trailing characters removed (default chars: space)
+        basic_string rstrip( const base &chars = base() ) const &
+        {
+            return strip( chars, false, true );
+        }
+        basic_string rstrip( const base &chars = base() ) &&
+        {
+            return std::move( *this ).strip( chars, false, true );
+        }
+        basic_string rtrim( const base &chars = base() ) const &
+        {
+            return strip( chars, false, true );
+        }
+        basic_string rtrim( const base &chars = base() ) &&
+        {
+            return std::move( *this ).strip( chars, false, true );
+        }
+
+        // Return a copy of the string with both leading and trailing characters removed (default chars: space)
+        basic_string strip( const base &chars = base() ) const &
+        {
+            return strip( chars, true, true );
+        }
+        basic_string strip( const base &chars = base() ) &&
+        {
+            return std::move( *this ).strip( chars, true, true );
+        }
+        basic_string trim( const base &chars = base() ) const &
+        {
+            return strip( chars, true, true );
+        }
+        basic_string trim( const base &chars = base() ) &&
+        {
+            return std::move( *this ).strip( chars, true, true );
+        }
+
+        bool starts_with( const base &prefix ) const
+        {
+            return view().starts_with( prefix );
+        }
+
+        bool starts_withi( const base &prefix ) const
+        {
+            return view().starts_withi( prefix );
+        }
+
+        bool ends_with( const base &suffix ) const
+        {
+            return view().ends_with( suffix );
+        }
+
+        bool ends_withi( const base &suffix ) const
+        {
+            return view().ends_withi( suffix );
+        }
+
+        wire::tokens tokens( const base &delimiters ) const {
+            return wire::tokens( view(), delimiters );
+        }
+
+        wire::splits splits( const base &delimiters ) const {
+            return wire::splits( view(), delimiters );
+        }
+
+        list_type tokenize( const base &delimiters ) const {
+            wire$probe( tokenize );
+            list_type out( typename list_type::allocator_type( this->get_allocator() ) );
+            for( const string_view &token : wire::tokens( view(), delimiters ) ) out.emplace_back( basic_string( token, this->get_allocator() ) );
+            wire$probe_result_list( out );
+            return out;
+        }
+
+        // tokenize_incl_separators
+        list_type split( const base &delimiters ) const {
+            wire$probe( split );
+            list_type out( typename list_type::allocator_type( this->get_allocator() ) );
+            for( const string_view &token : wire::splits( view(), delimiters ) ) out.emplace_back( basic_string( token, this->get_allocator() ) );
+            wire$probe_result_list( out );
+            return out;
+        }
+    };
+
+    // Monotonic arena: bump allocation out of growing blocks, all released at once by release() or the destructor.
+    // deallocate() is a no-op. Not thread-safe: keep one per request or per thread.
+    // wire::arena pool; wire::arena_string s( "hello", wire::arena_allocator<char>( pool ) );
+
+    class arena
+    {
+        public:
+
+        explicit arena( size_t block_size = 4096 ) : blocks( 0 ), cursor( 0 ), left( 0 ), block_size( block_size ), initial( 0 ), initial_size( 0 )
+        {}
+
+        // first allocations are served from a caller buffer (i.e. on the stack), then from the heap
+        arena( void *buffer, size_t size ) : blocks( 0 ), cursor( (char *)buffer ), left( size ), block_size( size > 64 ? size : 64 ), initial( (char *)buffer ), initial_size( size )
+        {}
+
+        arena( const arena & ) = delete;
+        arena &operator=( const arena & ) = delete;
+
+        ~arena() {
+            release();
+        }
+
+        void *allocate( size_t n, size_t align = alignof( std::max_align_t ) ) {
+            size_t pad = size_t( -(uintptr_t)cursor ) & ( align - 1 );
+            if( pad + n > left ) {
+                grow( n + align );
+                pad = size_t( -(uintptr_t)cursor ) & ( align - 1 );
+            }
+            void *p = cursor + pad;
+            cursor += pad + n, left -= pad + n;
+            return p;
+        }
+
+        // frees every heap block; the caller buffer (if any) is reused from the start
+        void release() {
+            while( blocks ) {
+                block *next = blocks->next;
+                ::operator delete( blocks );
+                blocks = next;
+            }
+            cursor = initial, left = initial_size;
+        }
+
+        private:
+
+        struct block {
+            block *next;
+        };
+
+        void grow( size_t n ) {
+            size_t size = block_size > n ? block_size : n;
+            block *b = (block *)::operator new( sizeof( block ) + size );
+            b->next = blocks, blocks = b;
+            cursor = (char *)( b + 1 ), left = size;
+            block_size *= 2;
+        }
+
+        block *blocks;
+        char *cursor;
+        size_t left, block_size;
+        char *initial;
+        size_t initial_size;
+    };
+
+    // Allocator over a wire::arena; a default-constructed one falls back to operator new/delete.
+
+    template< typename T >
+    class arena_allocator
+    {
+        public:
+
+        typedef T value_type;
+
+        arena_allocator() : pool( 0 )
+        {}
+
+        explicit arena_allocator( arena &pool ) : pool( &pool )
+        {}
+
+        template< typename U >
+        arena_allocator( const arena_allocator< U > &other ) : pool( other.pool )
+        {}
+
+        T *allocate( size_t n ) {
+            return (T *)( pool ? pool->allocate( n * sizeof( T ), alignof( T ) ) : ::operator new( n * sizeof( T ) ) );
+        }
+
+        void deallocate( T *p, size_t ) {
+            if( !pool ) ::operator delete( p );
+        }
+
+        template< typename U >
+        bool operator==( const arena_allocator< U > &other ) const { return pool == other.pool; }
+        template< typename U >
+        bool operator!=( const arena_allocator< U > &other ) const { return pool != other.pool; }
+
+        private:
+
+        template< typename U > friend class arena_allocator;
+        arena *pool;
+    };
+
+    typedef basic_string< arena_allocator< char > > arena_string;
+
+#if WIRE_PMR
+    namespace pmr
+    {
+        typedef basic_string< std::pmr::polymorphic_allocator< char > > string;
+    }
+#endif
+
+    // Join engine behind the str() printers: the format is parsed once, the whole output is reserved once (exact
+    // for string elements, estimated for the rest) and every element is formatted in place. The print() variants
+    // stream to a std::ostream or FILE * through a bounded buffer instead of building the whole output.
+
+    namespace
+    {
+        inline size_t length_of( const string_view &v ) { return v.size(); }
+        inline size_t length_of( const char *s )        { return s ? std::strlen( s ) : 0; }
+
+        template< typename T >
+        inline size_t length_of( const T &t, std::true_type /*is a string*/ ) { return t.size(); }
+        template< typename T >
+        inline size_t length_of( const T &, std::false_type )                 { return 8; }
+        template< typename T >
+        inline size_t length_of( const T &t )                                 { return length_of( t, decltype( is_string( (const T *)0 ) )() ); }
+
+        // what each printer formats out of an element: the element, ->first, ->second, or ->first and ->second
+        struct join_whole {
+            template< typename IT > static size_t size( const fmt &f, IT it ) { size_t len[] = { length_of( *it ) }; return f.size( len, 1 ); }
+            template< typename S, typename IT > static void append( const fmt &f, S &out, IT it ) { f.append( out, *it ); }
+        };
+        struct join_first {
+            template< typename IT > static size_t size( const fmt &f, IT it ) { size_t len[] = { length_of( it->first ) }; return f.size( len, 1 ); }
+            template< typename S, typename IT > static void append( const fmt &f, S &out, IT it ) { f.append( out, it->first ); }
+        };
+        struct join_second {
+            template< typename IT > static size_t size( const fmt &f, IT it ) { size_t len[] = { length_of( it->second ) }; return f.size( len, 1 ); }
+            template< typename S, typename IT > static void append( const fmt &f, S &out, IT it ) { f.append( out, it->second ); }
+        };
+        struct join_both {
+            template< typename IT > static size_t size( const fmt &f, IT it ) { size_t len[] = { length_of( it->first ), length_of( it->second ) }; return f.size( len, 2 ); }
+            template< typename S, typename IT > static void append( const fmt &f, S &out, IT it ) { f.append( out, it->first, it->second ); }
+        };
+
+        template< typename ELEMENT, typename S, typename IT >
+        inline S &join( S &out, IT begin, IT end, const fmt &f, const string_view &pre, const string_view &post ) {
+            size_t total = out.size() + pre.size() + post.size();
+            for( IT it = begin; it != end; ++it ) total += ELEMENT::size( f, it );
+            out.reserve( total );
+            out.append( pre.data(), pre.size() );
+            for( IT it = begin; it != end; ++it ) ELEMENT::append( f, out, it );
+            return out.append( post.data(), post.size() ), out;
+        }
+
+        struct to_ostream {
+            std::ostream &os;
+            size_t operator()( const std::string &chunk ) const { return os.write( chunk.data(), chunk.size() ) ? chunk.size() : 0; }
+        };
+        struct to_file {
+            FILE *fp;
+            size_t operator()( const std::string &chunk ) const { return std::fwrite( chunk.data(), 1, chunk.size(), fp ); }
+        };
+
+        // same output as join(), flushed every 64 KB. Returns bytes written
+        template< typename ELEMENT, typename IT, typename FLUSH >
+        inline size_t join_chunked( const FLUSH &flush, IT begin, IT end, const fmt &f, const string_view &pre, const string_view &post ) {
+            enum { chunk = 64 * 1024 };
+            std::string buffer;
+            buffer.reserve( chunk + chunk / 4 );
+            buffer.append( pre.data(), pre.size() );
+            size_t written = 0;
+            for( IT it = begin; it != end; ++it ) {
+                ELEMENT::append( f, buffer, it );
+                if( buffer.size() >= chunk ) written += flush( buffer ), buffer.clear();
+            }
+            buffer.append( post.data(), post.size() );
+            return written + flush( buffer );
+        }
+    }
+
+    // Fork-join pool behind the batch APIs. for_each( n, fn ) cuts [0, n) into chunks of a multiple of 64 items that
+    // the workers and the calling thread claim off a shared counter until none are left, so uneven items balance
+    // out. Ranges under the threshold, pools of one thread, and calls made from inside a running job (nested
+    // batches) run serially on the caller. The first exception thrown by fn is rethrown once the job is drained.
+    // wire::pool workers( 8, 4096 );   // 8 threads counting the caller, serial below 4096 items
+
+    class pool
+    {
+        public:
+
+        explicit pool( unsigned threads = 0, size_t threshold = 1024 ) : threshold( threshold ), generation( 0 ), busy( 0 ), stopping( false )
+        {
+            if( !threads ) threads = std::max( 1u, std::thread::hardware_concurrency() );
+            for( unsigned i = 1; i < threads; ++i )
+                workers.emplace_back( [this]{ work(); } );
+        }
+
+        ~pool()
+        {
+            {
+                std::lock_guard< std::mutex > lock( mutex );
+                stopping = true;
+            }
+            wake.notify_all();
+            for( auto &t : workers ) t.join();
+        }
+
+        pool( const pool & ) = delete;
+        pool &operator=( const pool & ) = delete;
+
+        // process-wide default: one thread per core, serial below 1024 items
+        static pool &shared()
+        {
+            static pool instance;
+            return instance;
+        }
+
+        unsigned size() const { return unsigned( workers.size() + 1 ); }
+
+        // calls fn( begin, end ) over disjoint subranges covering [0, n). Subranges start at multiples of grain
+        // (automatic, a multiple of 64, when 0); a serial run is a single fn( 0, n ) call.
+        template< typename FN >
+        void for_each( size_t n, const FN &fn, size_t grain = 0 )
+        {
+            if( n < threshold || workers.empty() || inside() ) {
+                if( n ) fn( size_t( 0 ), n );
+                return;
+            }
+            std::lock_guard< std::mutex > one_job( submit );
+            task = [&fn]( size_t begin, size_t end ) { fn( begin, end ); };
+            items = n;
+            this->grain = grain ? grain : std::max< size_t >( 64, ( n / ( size() * 8 ) + 63 ) / 64 * 64 );
+            next = 0;
+            error = nullptr;
+            {
+                std::lock_guard< std::mutex > lock( mutex );
+                busy = unsigned( workers.size() );
+                ++generation;
+            }
+            wake.notify_all();
+            run();
+            {
+                std::unique_lock< std::mutex > lock( mutex );
+                done.wait( lock, [this]{ return busy == 0; } );
+            }
+            task = nullptr;
+            if( error ) std::rethrow_exception( error );
+        }
+
+        private:
+
+        static bool &inside()
+        {
+            static thread_local bool flag = false;
+            return flag;
+        }
+
+        void run()
+        {
+            bool &nested = inside(), was = nested;
+            nested = true;
+            for( size_t begin; ( begin = next.fetch_add( grain ) ) < items; ) {
+                try {
+                    task( begin, std::min( begin + grain, items ) );
+                } catch( ... ) {
+                    std::lock_guard< std::mutex > lock( mutex );
+                    if( !error ) error = std::current_exception();
+                    next = items;
+                }
+            }
+            nested = was;
+        }
+
+        void work()
+        {
+            unsigned seen = 0;
+            for( ;; ) {
+                {
+                    std::unique_lock< std::mutex > lock( mutex );
+                    wake.wait( lock, [&]{ return stopping || generation != seen; } );
+                    if( stopping ) return;
+                    seen = generation;
+                }
+                run();
+                std::lock_guard< std::mutex > lock( mutex );
+                if( --busy == 0 ) done.notify_one();
+            }
+        }
+
+        size_t threshold;
+        std::vector< std::thread > workers;
+        std::mutex submit, mutex;
+        std::condition_variable wake, done;
+        unsigned generation, busy;
+        bool stopping;
+
+        // current job: written under submit before generation is bumped
+        std::function< void( size_t, size_t ) > task;
+        size_t items, grain;
+        std::atomic< size_t > next;
+        std::exception_ptr error;
+    };
+
+    class strings : public std::deque< string >
+    {
+        public:
+
+        strings() : std::deque< string >()
+        {}
+
+        strings( const int &argc, const char **&argv ) : std::deque< string >()
+        {
+            for( int i = 0; i < argc; ++i )
+                this->push_back( argv[i] );
+        }
+
+        strings( const int &argc, char **&argv ) : std::deque< string >()
+        {
+            for( int i = 0; i < argc; ++i )
+                this->push_back( argv[i] );
+        }
+
+        template< typename T, const size_t N >
+        strings( const T (&args)[N] ) : std::deque< string >()
+        {
+            this->resize( N );
+            for( int n = 0; n < N; ++n )
+                (*this)[ n ] = args[ n ];
+        }
+
+        template <typename CONTAINER>
+        strings( const CONTAINER &other ) : std::deque< string >( other.begin(), other.end() )
+        {}
+
+        template <typename CONTAINER>
+        strings &operator =( const CONTAINER &other ) {
+            if( &other != this ) {
+                *this = strings( other );
+            }
+            return *this;
+        }
+
+        template< typename T > strings( const T &t0, const T &t1 ) : std::deque< string >()
+        { this->resize(2); (*this)[0] = t0; (*this)[1] = t1; }
+        template< typename T > strings( const T &t0, const T &t1, const T &t2 ) : std::deque< string >()
+        { this->resize(3); (*this)[0] = t0; (*this)[1] = t1; (*this)[2] = t2; }
+        template< typename T > strings( const T &t0, const T &t1, const T &t2, const T &t3 ) : std::deque< string >()
+        { this->resize(4); (*this)[0] = t0; (*this)[1] = t1; (*this)[2] = t2; (*this)[3] = t3; }
+        template< typename T > strings( const T &t0, const T &t1, const T &t2, const T &t3, const T &t4 ) : std::deque< string >()
+        { this->resize(5); (*this)[0] = t0; (*this)[1] = t1; (*this)[2] = t2; (*this)[3] = t3; (*this)[4] = t4; }
+        template< typename T > strings( const T &t0, const T &t1, const T &t2, const T &t3, const T &t4, const T &t5 ) : std::deque< string >()
+        { this->resize(6); (*this)[0] = t0; (*this)[1] = t1; (*this)[2] = t2; (*this)[3] = t3; (*this)[4] = t4; (*this)[5] = t5; }
+        template< typename T > strings( const T &t0, const T &t1, const T &t2, const T &t3, const T &t4, const T &t5, const T &t6 ) : std::deque< string >()
+        { this->resize(7); (*this)[0] = t0; (*this)[1] = t1; (*this)[2] = t2; (*this)[3] = t3; (*this)[4] = t4; (*this)[5] = t5; (*this)[6] = t6; }
+
+        // at() never throws: empty containers return a reference to a per-thread empty scratch string instead
+
+        const string &at( const int &pos ) const
+        {
+            signed size = signed(this->size());
+            if( size )
+                return *( this->begin() + ( pos >= 0 ? pos % size : size - 1 + ((pos+1) % size) ) );
+            return sentinel();
+        }
+
+        string &at( const int &pos )
+        {
+            signed size = signed(this->size());
+            if( size )
+                return *( this->begin() + ( pos >= 0 ? pos % size : size - 1 + ((pos+1) % size) ) );
+            return sentinel();
+        }
+
+        private:
+        static string &sentinel()
+        {
+            static thread_local string str;
+            str.clear();
+            return str;
+        }
+        public:
+
+        const string &operator[]( const int &pos ) const {
+            return at(pos);
+        }
+        string &operator[]( const int &pos ) {
+            return at(pos);
+        }
+
+        // a single element is printed as pre + element + post, format1 aside
+        std::string str( const char *format1 = "\1\n", const std::string &pre = std::string(), const std::string &post = std::string() ) const
+        {
+            wire$probe( join );
+            std::string out;
+            join< join_whole >( out, this->begin(), this->end(), wire::fmt( this->size() == 1 ? "\1" : format1 ? format1 : "" ), pre, post );
+            wire$probe_result( out );
+            return out;
+        }
+
+        // streams str() without building it. Returns bytes written
+        size_t print( std::ostream &os, const char *format1 = "\1\n", const std::string &pre = std::string(), const std::string &post = std::string() ) const
+        {
+            return join_chunked< join_whole >( to_ostream{ os }, this->begin(), this->end(), wire::fmt( this->size() == 1 ? "\1" : format1 ? format1 : "" ), pre, post );
+        }
+
+        size_t print( FILE *fp, const char *format1 = "\1\n", const std::string &pre = std::string(), const std::string &post = std::string() ) const
+        {
+            return join_chunked< join_whole >( to_file{ fp }, this->begin(), this->end(), wire::fmt( this->size() == 1 ? "\1" : format1 ? format1 : "" ), pre, post );
+        }
+
+        // Batch operations, split across a wire::pool once there are enough elements. Callbacks run concurrently
+        // on different elements. as_all() and matches_all() write one slot each into out, which is also safe for
+        // std::vector< bool > since chunks are 64-aligned.
+
+        template< typename T >
+        size_t as_all( std::vector< T > &out, pool &workers = pool::shared() ) const
+        {
+            out.resize( this->size() );
+            workers.for_each( this->size(), [&]( size_t begin, size_t end ) {
+                for( size_t i = begin; i < end; ++i ) out[ i ] = item( i ).template as< T >();
+            } );
+            return out.size();
+        }
+
+        // fn( string & ) edits in place; any other return value is assigned back to the element
+        template< typename FN >
+        strings &transform( const FN &fn, pool &workers = pool::shared() )
+        {
+            workers.for_each( this->size(), [&]( size_t begin, size_t end ) {
+                for( size_t i = begin; i < end; ++i ) apply( fn, item( i ) );
+            } );
+            return *this;
+        }
+
+        strings &replace_all_map( const wire::replacer &compiled, pool &workers = pool::shared() )
+        {
+            return transform( [&]( const string &s ) { return s.replace_map( compiled ); }, workers );
+        }
+
+        std::vector< bool > matches_all( const wire::pattern &glob, pool &workers = pool::shared() ) const
+        {
+            std::vector< bool > out( this->size() );
+            workers.for_each( this->size(), [&]( size_t begin, size_t end ) {
+                for( size_t i = begin; i < end; ++i ) out[ i ] = glob.matches( item( i ) );
+            } );
+            return out;
+        }
+
+        std::vector< bool > matches_all( const std::string &glob, pool &workers = pool::shared() ) const
+        {
+            return matches_all( wire::pattern( glob ), workers );
+        }
+
+        private:
+        const string &item( size_t i ) const { return std::deque< string >::operator[]( i ); }
+        string &item( size_t i )             { return std::deque< string >::operator[]( i ); }
+
+        template< typename FN > static void apply( const FN &fn, string &s, std::true_type /*void*/ ) { fn( s ); }
+        template< typename FN > static void apply( const FN &fn, string &s, std::false_type )         { s = fn( s ); }
+        template< typename FN > static void apply( const FN &fn, string &s )                          { apply( fn, s, std::is_void< decltype( fn( s ) ) >() ); }
+        public:
+
+        inline friend std::ostream &operator <<( std::ostream &os, const wire::strings &self ) {
+            return self.print( os ), os;
+        }
+    };
+
+    namespace
+    {
+        template< typename RANGE >
+        inline size_t assign_range( strings &out, const RANGE &range ) {
+            size_t n = 0;
+            for( const string_view &token : range ) {
+                if( n < out.size() ) out.std::deque< string >::operator[]( n ).assign( token.data(), token.size() );
+                else out.emplace_back( token );
+                n++;
+            }
+            out.resize( n );
+            return n;
+        }
+    }
+
+    // Eager tokenize()/split() into a caller-provided list, returning the token count.
+    // Existing elements are reused in place and keep their capacity, so a loop over many lines stops allocating once warm.
+
+    inline size_t tokenize( const string_view &text, const charset &delimiters, strings &out ) {
+        wire$probe_list_on( tokenize, out );
+        return assign_range( out, tokens( text, delimiters ) );
+    }
+
+    inline size_t tokenize( const string_view &text, const string_view &delimiters, strings &out ) {
+        wire$probe_list_on( tokenize, out );
+        return assign_range( out, tokens( text, delimiters ) );
+    }
+
+    inline size_t split( const string_view &text, const charset &delimiters, strings &out ) {
+        wire$probe_list_on( split, out );
+        return assign_range( out, splits( text, delimiters ) );
+    }
+
+    inline size_t split( const string_view &text, const string_view &delimiters, strings &out ) {
+        wire$probe_list_on( split, out );
+        return assign_range( out, splits( text, delimiters ) );
+    }
+
+    // count(), replace() and tokenize() for single buffers of hundreds of MB, chunked across a wire::pool and
+    // stitched in order: results are identical to the serial calls. Texts under 256 KB, or one-thread pools, are
+    // processed as a single chunk on the caller.
+    // - count()/replace() scan every chunk with a (target length - 1) overlap. When a match straddles a boundary,
+    //   the next chunk replays its scan from the match end until it meets the first pass again.
+    // - replace() sizes the output of every chunk, and a prefix sum of those sizes gives each one its offset in
+    //   the single, preallocated result.
+    // - tokenize() moves every boundary forward to the next delimiter, then counts, sizes and fills the same way.
+    // size_t hits = wire::parallel::count( log, "ERROR" );
+
+    namespace parallel
+    {
+        namespace
+        {
+            inline size_t chunk_bytes( size_t size, const pool &workers ) {
+                if( size < ( 1u << 18 ) || workers.size() == 1 ) return size ? size : 1;
+                return std::max< size_t >( 1u << 16, ( size / ( workers.size() * 4 ) + 4095 ) / 4096 * 4096 );
+            }
+
+            template< typename FN >
+            inline void for_chunks( pool &workers, size_t size, size_t chunk, const FN &fn ) {
+                const size_t chunks = ( size + chunk - 1 ) / chunk;
+                if( chunks < 2 ) { if( chunks ) fn( size_t( 0 ) ); return; }
+                workers.for_each( size, [&]( size_t begin, size_t end ) {
+                    for( size_t c = begin / chunk; c * chunk < end; ++c ) fn( c );
+                }, chunk );
+            }
+
+            // greedy, non-overlapping matches starting in [start, stop); the next chunk starts at resume
+            struct span {
+                const char *start, *resume;
+                size_t matches;
+            };
+
+            inline const char *scan_limit( const finder &f, const char *stop, const char *end ) {
+                return size_t( end - stop ) > f.len - 1 ? stop + f.len - 1 : end;
+            }
+
+            inline span scan( const finder &f, const char *start, const char *stop, const char *end ) {
+                span s = { start, std::max( start, stop ), 0 };
+                if( start >= stop ) return s;
+                const char *limit = scan_limit( f, stop, end );
+                for( const char *p = start; ( p = f.find( p, limit ) ); p += f.len ) s.matches++, s.resume = p + f.len;
+                s.resume = std::max( s.resume, stop );
+                return s;
+            }
+
+            // first pass scanned from the chunk boundary, but the previous match ends at start: walk both chains
+            // until they share a match (from there on they agree) or run out of chunk. Self-overlapping targets
+            // in long periodic runs ("aaa" over "aaaa...") keep both chains apart, so the walk gives up past a
+            // short horizon and the chunk is scanned again from start instead (one chain, not two)
+            inline span replay( const finder &f, const span &first, const char *start, const char *stop, const char *end ) {
+                const char *limit = scan_limit( f, stop, end );
+                const char *horizon = size_t( limit - start ) > 64 * f.len + 4096 ? start + 64 * f.len + 4096 : limit;
+                const char *a = f.find( first.start, limit ), *b = start < stop ? f.find( start, limit ) : 0, *last = start;
+                size_t dropped = 0, added = 0;
+                while( a != b ) {
+                    bool first_chain = a && ( !b || a < b );
+                    if( ( first_chain ? a : b ) >= horizon ) return scan( f, start, stop, end );
+                    if( first_chain ) dropped++, a = f.find( a + f.len, limit );
+                    else added++, last = b + f.len, b = f.find( b + f.len, limit );
+                }
+                span s = { start, a ? first.resume : std::max( last, stop ), a ? first.matches - dropped + added : added };
+                return s;
+            }
+
+            inline std::vector< span > scan_chunks( pool &workers, const finder &f, const string_view &text ) {
+                const size_t size = text.size(), chunk = chunk_bytes( size, workers );
+                const char *begin = text.begin(), *end = text.end();
+                std::vector< span > spans( ( size + chunk - 1 ) / chunk );
+                for_chunks( workers, size, chunk, [&]( size_t c ) {
+                    spans[c] = scan( f, begin + c * chunk, begin + std::min( size, ( c + 1 ) * chunk ), end );
+                } );
+                for( size_t c = 1; c < spans.size(); ++c )
+                    if( spans[c].start != spans[c - 1].resume )
+                        spans[c] = replay( f, spans[c], spans[c - 1].resume, begin + std::min( size, ( c + 1 ) * chunk ), end );
+                return spans;
+            }
+
+            template< typename S >
+            inline S &replace_into( S &out, pool &workers, const string_view &text, const string_view &target, const string_view &replacement, search hint ) {
+                if( target.empty() ) return out.assign( text.data(), text.size() ), out;
+                finder f( target.data(), target.size(), hint );
+                if( chunk_bytes( text.size(), workers ) >= text.size() ) {
+                    const char *p = text.begin(), *end = text.end(), *found;
+                    size_t n = 0;
+                    for( const char *q = p; ( q = f.find( q, end ) ); q += target.size() ) n++;
+                    out.clear();
+                    out.reserve( text.size() - n * target.size() + n * replacement.size() );
+                    for( ; ( found = f.find( p, end ) ); p = found + target.size() )
+                        out.append( p, found ).append( replacement.data(), replacement.size() );
+                    return out.append( p, end ), out;
+                }
+                std::vector< span > spans = scan_chunks( workers, f, text );
+                std::vector< size_t > offsets( spans.size() + 1, 0 );
+                for( size_t c = 0; c < spans.size(); ++c )
+                    offsets[c + 1] = offsets[c] + size_t( spans[c].resume - spans[c].start ) - spans[c].matches * target.size() + spans[c].matches * replacement.size();
+                out.resize( offsets.back() );
+                if( out.empty() ) return out;
+                char *base = &*out.begin();
+                for_chunks( workers, text.size(), chunk_bytes( text.size(), workers ), [&]( size_t c ) {
+                    char *w = base + offsets[c];
+                    const char *p = spans[c].start, *found;
+                    for( ; ( found = f.find( p, spans[c].resume ) ); p = found + target.size() ) {
+                        std::memcpy( w, p, found - p ), w += found - p;
+                        std::memcpy( w, replacement.data(), replacement.size() ), w += replacement.size();
+                    }
+                    std::memcpy( w, p, spans[c].resume - p );
+                } );
+                return out;
+            }
+
+            inline size_t assign_all( strings &out, const tokens &range ) { return assign_range( out, range ); }
+            inline size_t assign_all( std::deque< string_view > &out, const tokens &range ) {
+                out.clear();
+                for( const string_view &token : range ) out.push_back( token );
+                return out.size();
+            }
+
+            // chunk c tokenizes [cuts[c], cuts[c + 1]); every inner cut is a delimiter or the end of the text
+            template< typename LIST, typename ASSIGN >
+            inline size_t tokenize_into( LIST &out, pool &workers, const string_view &text, const charset &delimiters, const ASSIGN &assign ) {
+                const size_t size = text.size(), chunk = chunk_bytes( size, workers ), chunks = ( size + chunk - 1 ) / chunk;
+                if( chunks < 2 ) return assign_all( out, tokens( text, delimiters ) );
+                const char *begin = text.begin(), *end = text.end();
+                std::vector< const char * > cuts( chunks + 1, end );
+                for_chunks( workers, size, chunk, [&]( size_t c ) {
+                    const char *stop = begin + std::min( size, ( c + 1 ) * chunk );
+                    cuts[c] = c ? delimiters.find( begin + c * chunk, stop ) : begin;
+                    if( cuts[c] == stop && stop != end ) cuts[c] = 0;   // no delimiter: the previous chunk takes it over
+                } );
+                for( size_t c = chunks; c-- > 0; ) if( !cuts[c] ) cuts[c] = cuts[c + 1];
+                std::vector< size_t > offsets( chunks + 1, 0 );
+                for_chunks( workers, size, chunk, [&]( size_t c ) {
+                    offsets[c + 1] = tokens( string_view( cuts[c], size_t( cuts[c + 1] - cuts[c] ) ), delimiters ).size();
+                } );
+                for( size_t c = 0; c < chunks; ++c ) offsets[c + 1] += offsets[c];
+                out.resize( offsets.back() );
+                for_chunks( workers, size, chunk, [&]( size_t c ) {
+                    size_t n = offsets[c];
+                    for( const string_view &token : tokens( string_view( cuts[c], size_t( cuts[c + 1] - cuts[c] ) ), delimiters ) ) assign( out, n++, token );
+                } );
+                return out.size();
+            }
+        }
+
+        inline size_t count( const string_view &text, const string_view &target, pool &workers = pool::shared(), search hint = search::automatic ) {
+            if( target.empty() || chunk_bytes( text.size(), workers ) >= text.size() ) return text.count( target, hint );
+            size_t n = 0;
+            for( const span &s : scan_chunks( workers, finder( target.data(), target.size(), hint ), text ) ) n += s.matches;
+            return n;
+        }
+
+        template< typename Alloc >
+        inline basic_string< Alloc > replace( const basic_string< Alloc > &text, const string_view &target, const string_view &replacement, pool &workers = pool::shared(), search hint = search::automatic ) {
+            basic_string< Alloc > out( text.get_allocator() );
+            replace_into( out, workers, text, target, replacement, hint );
+            return out;
+        }
+
+        inline string replace( const string_view &text, const string_view &target, const string_view &replacement, pool &workers = pool::shared(), search hint = search::automatic ) {
+            string out;
+            replace_into( out, workers, text, target, replacement, hint );
+            return out;
+        }
+
+        inline std::deque< string_view > tokenize( const string_view &text, const charset &delimiters, pool &workers = pool::shared() ) {
+            std::deque< string_view > out;
+            tokenize_into( out, workers, text, delimiters, []( std::deque< string_view > &list, size_t i, const string_view &token ) { list[i] = token; } );
+            return out;
+        }
+
+        inline std::deque< string_view > tokenize( const string_view &text, const string_view &delimiters, pool &workers = pool::shared() ) {
+            return tokenize( text, charset( delimiters.data(), delimiters.size() ), workers );
+        }
+
+        // like wire::tokenize( text, delimiters, out ): existing elements are reused in place
+        inline size_t tokenize( const string_view &text, const charset &delimiters, strings &out, pool &workers = pool::shared() ) {
+            return tokenize_into( out, workers, text, delimiters, []( strings &list, size_t i, const string_view &token ) {
+                list.std::deque< string >::operator[]( i ).assign( token.data(), token.size() );
+            } );
+        }
+
+        inline size_t tokenize( const string_view &text, const string_view &delimiters, strings &out, pool &workers = pool::shared() ) {
+            return tokenize( text, charset( delimiters.data(), delimiters.size() ), out, workers );
+        }
+    }
+
+    // Contiguous, read-only list of strings: every char lives in one growing arena, indexed by offset+length.
+    // Elements are string_views into the arena (valid until the next push_back() or clear()). A million entries are
+    // still two allocations, freed at once; clear() keeps both for reuse. Same at() wrap-around and str() as wire::strings.
+
+    class string_table
+    {
+        public:
+
+        class const_iterator
+        {
+            public:
+
+            typedef std::random_access_iterator_tag iterator_category;
+            typedef string_view value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const string_view *pointer;
+            typedef string_view reference;
+
+            const_iterator() : table( 0 ), i( 0 )
+            {}
+
+            const_iterator( const string_table *table, size_t i ) : table( table ), i( i )
+            {}
+
+            string_view operator*() const { return table->view( i ); }
+            string_view operator[]( difference_type n ) const { return table->view( i + n ); }
+
+            const_iterator &operator++() { return ++i, *this; }
+            const_iterator &operator--() { return --i, *this; }
+            const_iterator operator++( int ) { const_iterator it = *this; return ++i, it; }
+            const_iterator operator--( int ) { const_iterator it = *this; return --i, it; }
+            const_iterator &operator+=( difference_type n ) { return i += n, *this; }
+            const_iterator &operator-=( difference_type n ) { return i -= n, *this; }
+            const_iterator operator+( difference_type n ) const { return const_iterator( table, i + n ); }
+            const_iterator operator-( difference_type n ) const { return const_iterator( table, i - n ); }
+            difference_type operator-( const const_iterator &other ) const { return difference_type( i ) - difference_type( other.i ); }
+
+            bool operator==( const const_iterator &other ) const { return i == other.i; }
+            bool operator!=( const const_iterator &other ) const { return i != other.i; }
+            bool operator<( const const_iterator &other ) const { return i < other.i; }
+
+            private:
+
+            const string_table *table;
+            size_t i;
+        };
+
+        typedef const_iterator iterator;
+
+        string_table()
+        {}
+
+        template <typename CONTAINER>
+        explicit string_table( const CONTAINER &other )
+        {
+            for( typename CONTAINER::const_iterator it = other.begin(), end = other.end(); it != end; ++it )
+                push_back( *it );
+        }
+
+        void reserve( size_t count, size_t bytes ) {
+            index.reserve( count );
+            arena.reserve( bytes );
+        }
+
+        void push_back( const string_view &str ) {
+            index.push_back( entry( arena.size(), str.size() ) );
+            arena.append( str.data(), str.size() );
+        }
+
+        void clear() {
+            index.clear();
+            arena.clear();
+        }
+
+        size_t size() const { return index.size(); }
+        bool empty() const { return index.empty(); }
+        size_t bytes() const { return arena.size(); }
+
+        const_iterator begin() const { return const_iterator( this, 0 ); }
+        const_iterator end() const { return const_iterator( this, index.size() ); }
+
+        // at() extended behaviour: wraps around both ways; empty tables return an empty view
+        string_view at( const int &pos ) const
+        {
+            signed size = signed( index.size() );
+            if( size )
+                return view( pos >= 0 ? pos % size : size - 1 + ((pos+1) % size) );
+            return string_view();
+        }
+
+        string_view operator[]( const int &pos ) const {
+            return at( pos );
+        }
+
+        string_view front() const { return at( 0 ); }
+        string_view back() const { return at( -1 ); }
+
+        // a single element is printed as pre + element + post, format1 aside
+        std::string str( const char *format1 = "\1\n", const std::string &pre = std::string(), const std::string &post = std::string() ) const
+        {
+            std::string out;
+            join< join_whole >( out, begin(), end(), wire::fmt( index.size() == 1 ? "\1" : format1 ? format1 : "" ), pre, post );
+            return out;
+        }
+
+        // streams str() without building it. Returns bytes written
+        size_t print( std::ostream &os, const char *format1 = "\1\n", const std::string &pre = std::string(), const std::string &post = std::string() ) const
+        {
+            return join_chunked< join_whole >( to_ostream{ os }, begin(), end(), wire::fmt( index.size() == 1 ? "\1" : format1 ? format1 : "" ), pre, post );
+        }
+
+        size_t print( FILE *fp, const char *format1 = "\1\n", const std::string &pre = std::string(), const std::string &post = std::string() ) const
+        {
+            return join_chunked< join_whole >( to_file{ fp }, begin(), end(), wire::fmt( index.size() == 1 ? "\1" : format1 ? format1 : "" ), pre, post );
+        }
+
+        inline friend std::ostream &operator <<( std::ostream &os, const wire::string_table &self ) {
+            return self.print( os ), os;
+        }
+
+        private:
+
+        struct entry {
+            size_t offset, length;
+            entry( size_t offset, size_t length ) : offset( offset ), length( length )
+            {}
+        };
+
+        string_view view( size_t i ) const {
+            return string_view( arena.data() + index[i].offset, index[i].length );
+        }
+
+        std::string arena;
+        std::vector< entry > index;
+    };
+
+    namespace
+    {
+        template< typename RANGE >
+        inline size_t assign_range( string_table &out, const RANGE &range, size_t bytes ) {
+            out.clear();
+            out.reserve( range.size(), bytes );
+            for( const string_view &token : range )
+                out.push_back( token );
+            return out.size();
+        }
+    }
+
+    // Eager tokenize()/split() straight into a string_table. A first counting pass sizes the index, and the arena
+    // is reserved for the whole text, so each call allocates at most twice.
+
+    inline size_t tokenize( const string_view &text, const charset &delimiters, string_table &out ) {
+        return assign_range( out, tokens( text, delimiters ), text.size() );
+    }
+
+    inline size_t tokenize( const string_view &text, const string_view &delimiters, string_table &out ) {
+        return assign_range( out, tokens( text, delimiters ), text.size() );
+    }
+
+    inline size_t split( const string_view &text, const charset &delimiters, string_table &out ) {
+        return assign_range( out, splits( text, delimiters ), text.size() );
+    }
+
+    inline size_t split( const string_view &text, const string_view &delimiters, string_table &out ) {
+        return assign_range( out, splits( text, delimiters ), text.size() );
+    }
+
+    // String with inline room for N chars: up to N stay inside the object (no heap), longer ones move to the heap
+    // and grow geometrically. It forwards the read-only extended API of a view over its own chars (at(), find(),
+    // count(), matches(), strip(), left_of(), tokens(), tokenize(), as<T>(), comparisons, ostream <<), with appends,
+    // << chaining, c_str() and resize() on top. It converts to a string_view but is not one, so nothing can
+    // repoint its chars through a base reference. Views it returns are valid until it changes. Converts both ways
+    // with wire::string; sizeof( wire::small_string<32> ) is 64 on LP64.
+    // std::vector< wire::small_string<32> > fields; wire::tokenize( line, ",", fields );
+
+    template< size_t N >
+    class small_string
+    {
+        public:
+
+        enum { inline_capacity = N };
+        static const size_t npos = string_view::npos;
+
+        small_string() : ptr( local ), len( 0 ), room( N )
+        {
+            local[0] = '\0';
+        }
+
+        small_string( const char *ptr, size_t len ) : small_string()
+        {
+            assign( ptr, len );
+        }
+
+        small_string( const char *cstr ) : small_string()
+        {
+            assign( string_view( cstr ) );
+        }
+
+        small_string( const string_view &v ) : small_string()
+        {
+            assign( v );
+        }
+
+        small_string( const small_string &s ) : small_string()
+        {
+            assign( s );
+        }
+
+        small_string( small_string &&s ) noexcept : small_string()
+        {
+            take( s );
+        }
+
+        // other strings are copied as is, other types formatted (as wire::string() does)
+        template< typename T >
+        small_string( const T &t ) : small_string()
+        {
+            piece p;
+            p.set( t );
+            assign( p.ptr, p.len );
+        }
+
+        ~small_string() {
+            if( !is_inline() ) delete [] chars();
+        }
+
+        small_string &operator=( const small_string &s ) {
+            return assign( s );
+        }
+
+        small_string &operator=( small_string &&s ) noexcept {
+            if( this != &s ) {
+                if( !is_inline() ) delete [] chars();
+                ptr = local, len = 0, room = N, local[0] = '\0';
+                take( s );
+            }
+            return *this;
+        }
+
+        small_string &operator=( const string_view &v ) {
+            return assign( v );
+        }
+
+        small_string &operator=( const char *cstr ) {
+            return assign( string_view( cstr ) );
+        }
+
+        // storage
+
+        bool is_inline() const { return ptr == local; }
+        size_t capacity() const { return room; }
+        const char *c_str() const { return ptr; }
+
+        void reserve( size_t n ) {
+            if( n > room ) grow( n );
+        }
+
+        void clear() {
+            chars()[ len = 0 ] = '\0';
+        }
+
+        // keeps the heap block, if any
+        void resize( size_t n, char c = '\0' ) {
+            if( n > room ) grow( std::max( n, room * 2 ) );
+            if( n > len ) std::memset( chars() + len, c, n - len );
+            chars()[ len = n ] = '\0';
+        }
+
+        void swap( small_string &s ) {
+            small_string tmp( std::move( s ) );
+            s = std::move( *this );
+            *this = std::move( tmp );
+        }
+
+        // edits
+
+        small_string &assign( const char *p, size_t n ) {
+            if( n > room ) {
+                // p may live in our own block
+                small_string tmp;
+                tmp.grow( n );
+                std::memcpy( tmp.chars(), p, n );
+                tmp.chars()[ tmp.len = n ] = '\0';
+                return *this = std::move( tmp );
+            }
+            std::memmove( chars(), p, n );
+            chars()[ len = n ] = '\0';
+            return *this;
+        }
+
+        small_string &assign( const string_view &v ) {
+            return assign( v.data(), v.size() );
+        }
+
+        small_string &append( const char *p, size_t n ) {
+            if( len + n > room ) {
+                bool self = p >= ptr && p < ptr + len;
+                size_t offset = self ? size_t( p - ptr ) : 0;
+                grow( std::max( len + n, room * 2 ) );
+                if( self ) p = ptr + offset;
+            }
+            std::memcpy( chars() + len, p, n );
+            len += n;
+            chars()[ len ] = '\0';
+            return *this;
+        }
+
+        small_string &append( const string_view &v ) {
+            return append( v.data(), v.size() );
+        }
+
+        void push_back( char c ) {
+            append( &c, 1 );
+        }
+
+        void pop_back() {
+            if( len ) chars()[ --len ] = '\0';
+        }
+
+        // at() extended behaviour, writable: "hello"[5] = h, "hello"[-1] = o; empty strings return a scratch '\0'
+        const char &at( const int &pos ) const { return view().at( pos ); }
+        const char &operator[]( const int &pos ) const { return view().at( pos ); }
+        const char &front() const { return view().front(); }
+        const char &back() const { return view().back(); }
+
+        char &at( const int &pos ) {
+            static thread_local char scratch;
+            return len ? const_cast< char & >( view().at( pos ) ) : ( scratch = '\0' );
+        }
+
+        char &operator[]( const int &pos ) {
+            return at( pos );
+        }
+
+        char &front() {
+            return at( 0 );
+        }
+
+        char &back() {
+            return at( -1 );
+        }
+
+        template< typename T >
+        small_string &operator <<( const T &t ) {
+            piece p;
+            p.set( t );
+            return append( p.ptr, p.len );
+        }
+
+        template< typename T >
+        small_string &operator +=( const T &t ) {
+            return operator<<( t );
+        }
+
+        // read-only API, forwarded to a view over the chars
+
+        string_view view() const { return string_view( ptr, len ); }
+        operator string_view() const { return view(); }
+
+        const char *data() const { return ptr; }
+        const char *begin() const { return ptr; }
+        const char *end() const { return ptr + len; }
+        size_t size() const { return len; }
+        size_t length() const { return len; }
+        bool empty() const { return !len; }
+
+        string_view substr( size_t pos, size_t n = npos ) const { return view().substr( pos, n ); }
+        size_t find( const char &ch, size_t pos = 0 ) const { return view().find( ch, pos ); }
+        size_t find( const string_view &s, size_t pos = 0 ) const { return view().find( s, pos ); }
+        size_t count( const string_view &s, search hint = search::automatic ) const { return view().count( s, hint ); }
+
+        std::string str( const std::string &pre = std::string(), const std::string &post = std::string() ) const { return view().str( pre, post ); }
+
+        bool matches( const string_view &pattern ) const { return view().matches( pattern ); }
+        bool matchesi( const string_view &pattern ) const { return view().matchesi( pattern ); }
+        bool matches( const wire::pattern &pattern ) const { return view().matches( pattern ); }
+        bool matchesi( const wire::pattern &pattern ) const { return view().matchesi( pattern ); }
+
+        string_view left_of( const string_view &s ) const { return view().left_of( s ); }
+        string_view right_of( const string_view &s ) const { return view().right_of( s ); }
+
+        string_view lstrip( const string_view &chars = string_view() ) const { return view().lstrip( chars ); }
+        string_view ltrim( const string_view &chars = string_view() ) const { return view().ltrim( chars ); }
+        string_view rstrip( const string_view &chars = string_view() ) const { return view().rstrip( chars ); }
+        string_view rtrim( const string_view &chars = string_view() ) const { return view().rtrim( chars ); }
+        string_view strip( const string_view &chars = string_view() ) const { return view().strip( chars ); }
+        string_view trim( const string_view &chars = string_view() ) const { return view().trim( chars ); }
+
+        bool starts_with( const string_view &prefix ) const { return view().starts_with( prefix ); }
+        bool ends_with( const string_view &suffix ) const { return view().ends_with( suffix ); }
+        bool starts_withi( const string_view &prefix ) const { return view().starts_withi( prefix ); }
+        bool ends_withi( const string_view &suffix ) const { return view().ends_withi( suffix ); }
+
+        wire::tokens tokens( const string_view &delimiters ) const;
+        wire::splits splits( const string_view &delimiters ) const;
+        std::deque< string_view > tokenize( const string_view &delimiters ) const { return view().tokenize( delimiters ); }
+        std::deque< string_view > split( const string_view &delimiters ) const { return view().split( delimiters ); }
+
+        template< typename T >
+        T as() const { return view().template as< T >(); }
+
+        template< typename T >
+        bool try_as( T &t ) const { return view().try_as( t ); }
+
+        // comparison, byte-wise against any string
+
+        friend bool operator ==( const small_string &a, const small_string &b ) { return a.view() == b.view(); }
+        friend bool operator ==( const small_string &a, const string_view &b )  { return a.view() == b; }
+        friend bool operator ==( const string_view &a, const small_string &b )  { return a == b.view(); }
+        friend bool operator ==( const small_string &a, const char *b )         { return a.view() == string_view( b ); }
+        friend bool operator ==( const char *a, const small_string &b )         { return string_view( a ) == b.view(); }
+        template< typename A >
+        friend bool operator ==( const small_string &a, const std::basic_string< char, std::char_traits< char >, A > &b ) { return a.view() == string_view( b ); }
+        template< typename A >
+        friend bool operator ==( const std::basic_string< char, std::char_traits< char >, A > &a, const small_string &b ) { return string_view( a ) == b.view(); }
+
+        template< typename T >
+        friend bool operator !=( const small_string &a, const T &b ) { return !( a == b ); }
+        friend bool operator !=( const string_view &a, const small_string &b ) { return !( a == b ); }
+        friend bool operator !=( const char *a, const small_string &b ) { return !( a == b ); }
+
+        friend bool operator <( const small_string &a, const small_string &b ) { return a.view() < b.view(); }
+        friend bool operator <( const small_string &a, const string_view &b )  { return a.view() < b; }
+        friend bool operator <( const string_view &a, const small_string &b )  { return a < b.view(); }
+
+        inline friend std::ostream &operator <<( std::ostream &os, const small_string &self ) {
+            return os << self.view();
+        }
+
+        // conversion to a wire::string with the full mutating API
+        wire::string wstr() const {
+            return wire::string( data(), size() );
+        }
+
+        private:
+
+        // parse target of as< small_string<N> >(), and what wire::string's operator T() yields
+        friend bool parse( const char *begin, const char *end, small_string &t ) {
+            return t.assign( begin, size_t( end - begin ) ), true;
+        }
+
+        char *chars() {
+            return const_cast< char * >( ptr );
+        }
+
+        // moves to a heap block of n chars (plus terminator), keeping the contents
+        void grow( size_t n ) {
+            char *block = new char[ n + 1 ];
+            std::memcpy( block, ptr, len + 1 );
+            if( !is_inline() ) delete [] chars();
+            ptr = block, room = n;
+        }
+
+        // steals s's heap block, or copies its inline chars; s is left empty
+        void take( small_string &s ) {
+            if( s.is_inline() ) {
+                std::memcpy( local, s.local, s.len + 1 );
+                len = s.len;
+            } else {
+                ptr = s.ptr, len = s.len, room = s.room;
+                s.ptr = s.local, s.room = N;
+            }
+            s.len = 0, s.local[0] = '\0';
+        }
+
+        const char *ptr;
+        size_t len, room;
+        char local[ N + 1 ];
+    };
+
+    template< size_t N >
+    inline wire::tokens small_string< N >::tokens( const string_view &delimiters ) const {
+        return wire::tokens( view(), delimiters );
+    }
+
+    template< size_t N >
+    inline wire::splits small_string< N >::splits( const string_view &delimiters ) const {
+        return wire::splits( view(), delimiters );
+    }
+
+    namespace
+    {
+        template< size_t N, typename RANGE >
+        inline size_t assign_range( std::vector< small_string< N > > &out, const RANGE &range ) {
+            out.reserve( range.size() ); // a counting pass is cheaper than regrowing (moving) the vector
+            size_t n = 0;
+            for( const string_view &token : range ) {
+                if( n < out.size() ) out[ n ].assign( token );
+                else out.emplace_back( token );
+                n++;
+            }
+            out.resize( n );
+            return n;
+        }
+    }
+
+    // Eager tokenize()/split() into a vector of small strings: tokens up to N chars cost no allocation at all, and
+    // existing elements are reused in place.
+
+    template< size_t N >
+    inline size_t tokenize( const string_view &text, const charset &delimiters, std::vector< small_string< N > > &out ) {
+        return assign_range( out, tokens( text, delimiters ) );
+    }
+
+    template< size_t N >
+    inline size_t tokenize( const string_view &text, const string_view &delimiters, std::vector< small_string< N > > &out ) {
+        return assign_range( out, tokens( text, delimiters ) );
+    }
+
+    template< size_t N >
+    inline size_t split( const string_view &text, const charset &delimiters, std::vector< small_string< N > > &out ) {
+        return assign_range( out, splits( text, delimiters ) );
+    }
+
+    template< size_t N >
+    inline size_t split( const string_view &text, const string_view &delimiters, std::vector< small_string< N > > &out ) {
+        return assign_range( out, splits( text, delimiters ) );
+    }
+}
+
+#if WIRE_STATS
+// Instrumentation report
+
+namespace wire
+{
+    namespace stats
+    {
+        // One row per site and operation called so far, over every thread: "site op: calls=N allocated=N copied=N
+        // ticks=N" (site "-" outside any wire::stats::scope). Render it with report().str(), or print() it.
+        inline strings report() {
+            report_table all = snapshot();
+            strings rows;
+            for( const report_table::value_type &row : all )
+                for( int op = 0; op < operations; ++op ) {
+                    const totals &t = row.second[ op ];
+                    if( t.calls ) rows.push_back( wire::string( "\1 \2: calls=\3 allocated=\4 copied=\5 ticks=\6", row.first.empty() ? "-" : row.first.c_str(),
+                        name( operation( op ) ), t.calls, t.allocated, t.copied, t.ticks ) );
+                }
+            return rows;
+        }
+    }
+}
+#endif
+
+// File reader
+
+namespace wire
+{
+    // Lines and tokens out of a file of any size, as string_views (strip(), matches(), as<T>(), left_of()...).
+    // Files are memory-mapped with WIRE_POSIX (see top); otherwise, and for FILE * streams, they are read in
+    // chunk-sized blocks, so memory stays bounded by the chunk (or the longest line/token) whatever the file size.
+    // Views are valid until the next read from a streamed reader, and while the reader lives if mapped().
+    // Mapped pages already read past are dropped as the reader advances (they fault back in from the file if
+    // an older view is touched again), so resident memory stays bounded in both modes.
+    // wire::reader in( "huge.csv" ); for( wire::string_view line : in.lines() ) { ... }
+
+    class reader
+    {
+        public:
+
+        explicit reader( const std::string &path, size_t chunk = 1 << 20 ) : reader( (FILE *)0, chunk )
+        {
+#if WIRE_POSIX
+            int fd = ::open( path.c_str(), O_RDONLY );
+            if( fd >= 0 ) {
+                struct stat st;
+                if( ::fstat( fd, &st ) == 0 && S_ISREG( st.st_mode ) && st.st_size > 0 ) {
+                    void *p = ::mmap( 0, size_t( st.st_size ), PROT_READ, MAP_PRIVATE, fd, 0 );
+                    if( p != MAP_FAILED ) {
+                        ::madvise( p, size_t( st.st_size ), MADV_SEQUENTIAL );
+                        map = p, mapped_size = size_t( st.st_size );
+                        pos = (const char *)p, end = pos + mapped_size, at_eof = true;
+                        horizon = pos + 8 * this->chunk;
+                    }
+                }
+                ::close( fd );
+                if( map ) return;
+            }
+#endif
+            fp = std::fopen( path.c_str(), "rb" );
+            owned = true, at_eof = !fp;
+        }
+
+        // streams an already open FILE * (not closed by the reader)
+        explicit reader( FILE *fp, size_t chunk = 1 << 20 ) : fp( fp ), owned( false ), map( 0 ), mapped_size( 0 ), released( 0 ),
+            chunk( chunk ? chunk : 1 ), pos( 0 ), end( 0 ), horizon( 0 ), at_eof( !fp )
+        {}
+
+        ~reader() {
+#if WIRE_POSIX
+            if( map ) ::munmap( map, mapped_size );
+#endif
+            if( fp && owned ) std::fclose( fp );
+        }
+
+        reader( const reader & ) = delete;
+        reader &operator=( const reader & ) = delete;
+
+        bool good() const {
+            return map || fp;
+        }
+
+        bool mapped() const {
+            return map != 0;
+        }
+
+        // next line, without its "\n" or "\r\n". The last line needs no terminator
+        bool next_line( string_view &line ) {
+            if( map && pos >= horizon ) release();
+            for( size_t scanned = 0;; ) {
+                if( const char *nl = pos + scanned < end ? (const char *)std::memchr( pos + scanned, '\n', size_t( end - pos ) - scanned ) : 0 ) {
+                    line = string_view( pos, size_t( ( nl > pos && nl[-1] == '\r' ? nl - 1 : nl ) - pos ) );
+                    pos = nl + 1;
+                    return true;
+                }
+                scanned = size_t( end - pos );
+                if( !refill() ) break;
+            }
+            if( pos == end ) return false;
+            line = string_view( pos, size_t( ( end[-1] == '\r' ? end - 1 : end ) - pos ) );
+            pos = end;
+            return true;
+        }
+
+        // next non-empty run of chars not in delimiters, as tokenize() does
+        bool next_token( string_view &token, const charset &delimiters ) {
+            if( map && pos >= horizon ) release();
+            while( ( pos = delimiters.find_not( pos, end ) ) == end )
+                if( !refill() ) return false;
+            for( size_t scanned = 0;; ) {
+                const char *found = delimiters.find( pos + scanned, end );
+                if( found != end ) {
+                    token = string_view( pos, size_t( found - pos ) );
+                    pos = found + 1;
+                    return true;
+                }
+                scanned = size_t( end - pos );
+                if( !refill() ) break;
+            }
+            token = string_view( pos, size_t( end - pos ) );
+            pos = end;
+            return true;
+        }
+
+        // single-pass ranges: for( wire::string_view field : in.tokens( ",;\n" ) ) ...
+        class lines_range;
+        class tokens_range;
+
+        lines_range lines();
+        tokens_range tokens( const string_view &delimiters );
+        tokens_range tokens( const charset &delimiters );
+
+        private:
+
+        // keeps [pos, end) at the front of the buffer and reads more after it; false once nothing more comes
+        bool refill() {
+            if( at_eof ) return false;
+            size_t kept = size_t( end - pos );
+            if( kept && pos != buffer.data() ) std::memmove( &buffer[0], pos, kept );
+            if( kept == buffer.size() ) buffer.resize( std::max( chunk, buffer.size() * 2 ) );
+            size_t wanted = buffer.size() - kept, got = std::fread( &buffer[0] + kept, 1, wanted, fp );
+            at_eof = got < wanted;
+            pos = buffer.data(), end = pos + kept + got;
+            return got > 0;
+        }
+
+        // mapped: hands the pages before pos back to the kernel, every 8 chunks read
+        void release() {
+#if WIRE_POSIX
+            static const size_t page = size_t( ::sysconf( _SC_PAGESIZE ) );
+            size_t done = size_t( pos - (const char *)map ) / page * page;
+            ::madvise( (char *)map + released, done - released, MADV_DONTNEED );
+            released = done;
+            horizon = pos + 8 * chunk;
+#endif
+        }
+
+        FILE *fp;
+        bool owned;
+        void *map;
+        size_t mapped_size, released, chunk;
+        std::vector< char > buffer;
+        const char *pos, *end, *horizon;
+        bool at_eof;
+    };
+
+    class reader::lines_range
+    {
+        public:
+
+        class iterator
+        {
+            public:
+
+            typedef std::input_iterator_tag iterator_category;
+            typedef string_view value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const string_view *pointer;
+            typedef const string_view &reference;
+
+            iterator( reader *in = 0 ) : in( in ) { ++*this; }
+
+            const string_view &operator*() const { return cur; }
+            const string_view *operator->() const { return &cur; }
+            iterator &operator++() { if( in && !in->next_line( cur ) ) in = 0; return *this; }
+            bool operator==( const iterator &other ) const { return in == other.in; }
+            bool operator!=( const iterator &other ) const { return in != other.in; }
+
+            private:
+
+            reader *in;
+            string_view cur;
+        };
+
+        explicit lines_range( reader &in ) : in( &in )
+        {}
+
+        iterator begin() const { return iterator( in ); }
+        iterator end() const { return iterator(); }
+
+        private:
+
+        reader *in;
+    };
+
+    class reader::tokens_range
+    {
+        public:
+
+        class iterator
+        {
+            public:
+
+            typedef std::input_iterator_tag iterator_category;
+            typedef string_view value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const string_view *pointer;
+            typedef const string_view &reference;
+
+            iterator( reader *in = 0, const charset *set = 0 ) : in( in ), set( set ) { ++*this; }
+
+            const string_view &operator*() const { return cur; }
+            const string_view *operator->() const { return &cur; }
+            iterator &operator++() { if( in && !in->next_token( cur, *set ) ) in = 0; return *this; }
+            bool operator==( const iterator &other ) const { return in == other.in; }
+            bool operator!=( const iterator &other ) const { return in != other.in; }
+
+            private:
+
+            reader *in;
+            const charset *set;
+            string_view cur;
+        };
+
+        tokens_range( reader &in, const charset &set ) : in( &in ), set( set )
+        {}
+
+        iterator begin() const { return iterator( in, &set ); }
+        iterator end() const { return iterator(); }
+
+        private:
+
+        reader *in;
+        charset set;
+    };
+
+    inline reader::lines_range reader::lines() {
+        return lines_range( *this );
+    }
+
+    inline reader::tokens_range reader::tokens( const string_view &delimiters ) {
+        return tokens_range( *this, charset( delimiters.data(), delimiters.size() ) );
+    }
+
+    inline reader::tokens_range reader::tokens( const charset &delimiters ) {
+        return tokens_range( *this, delimiters );
+    }
+}
+
+// Generic print containers: str() formats each element with format1 (str1: ->first, str2: ->second,
+// str12: ->first and ->second), print() streams the same output to a std::ostream or FILE * and returns bytes written
+
+namespace wire
+{
+    template<typename T>
+    inline std::string str( const T& t, const std::string &format1, const std::string &pre = std::string(), const std::string &post = std::string() )
+    {
+        std::string out;
+        join< join_whole >( out, t.begin(), t.end(), wire::fmt( format1 ), pre, post );
+        return out;
+    }
+
+    template<typename T>
+    inline std::string str1( const T& t, const std::string &format1, const std::string &pre = std::string(), const std::string &post = std::string() )
+    {
+        std::string out;
+        join< join_first >( out, t.begin(), t.end(), wire::fmt( format1 ), pre, post );
+        return out;
+    }
+
+    template<typename T>
+    inline std::string str2( const T& t, const std::string &format1, const std::string &pre = std::string(), const std::string &post = std::string() )
+    {
+        std::string out;
+        join< join_second >( out, t.begin(), t.end(), wire::fmt( format1 ), pre, post );
+        return out;
+    }
+
+    template<typename T>
+    inline std::string str12( const T& t, const std::string &format12, const std::string &pre = std::string(), const std::string &post = std::string() )
+    {
+        std::string out;
+        join< join_both >( out, t.begin(), t.end(), wire::fmt( format12 ), pre, post );
+        return out;
+    }
+
+    template<typename T>
+    inline size_t print( std::ostream &os, const T& t, const std::string &format1, const std::string &pre = std::string(), const std::string &post = std::string() )
+    {
+        return join_chunked< join_whole >( to_ostream{ os }, t.begin(), t.end(), wire::fmt( format1 ), pre, post );
+    }
+
+    template<typename T>
+    inline size_t print( FILE *fp, const T& t, const std::string &format1, const std::string &pre = std::string(), const std::string &post = std::string() )
+    {
+        return join_chunked< join_whole >( to_file{ fp }, t.begin(), t.end(), wire::fmt( format1 ), pre, post );
+    }
+
+    template<typename T>
+    inline size_t print1( std::ostream &os, const T& t, const std::string &format1, const std::string &pre = std::string(), const std::string &post = std::string() )
+    {
+        return join_chunked< join_first >( to_ostream{ os }, t.begin(), t.end(), wire::fmt( format1 ), pre, post );
+    }
+
+    template<typename T>
+    inline size_t print1( FILE *fp, const T& t, const std::string &format1, const std::string &pre = std::string(), const std::string &post = std::string() )
+    {
+        return join_chunked< join_first >( to_file{ fp }, t.begin(), t.end(), wire::fmt( format1 ), pre, post );
+    }
+
+    template<typename T>
+    inline size_t print2( std::ostream &os, const T& t, const std::string &format1, const std::string &pre = std::string(), const std::string &post = std::string() )
+    {
+        return join_chunked< join_second >( to_ostream{ os }, t.begin(), t.end(), wire::fmt( format1 ), pre, post );
+    }
+
+    template<typename T>
+    inline size_t print2( FILE *fp, const T& t, const std::string &format1, const std::string &pre = std::string(), const std::string &post = std::string() )
+    {
+        return join_chunked< join_second >( to_file{ fp }, t.begin(), t.end(), wire::fmt( format1 ), pre, post );
+    }
+
+    template<typename T>
+    inline size_t print12( std::ostream &os, const T& t, const std::string &format12, const std::string &pre = std::string(), const std::string &post = std::string() )
+    {
+        return join_chunked< join_both >( to_ostream{ os }, t.begin(), t.end(), wire::fmt( format12 ), pre, post );
+    }
+
+    template<typename T>
+    inline size_t print12( FILE *fp, const T& t, const std::string &format12, const std::string &pre = std::string(), const std::string &post = std::string() )
+    {
+        return join_chunked< join_both >( to_file{ fp }, t.begin(), t.end(), wire::fmt( format12 ), pre, post );
+    }
+}
+
+// Segmented string builder
+
+namespace wire
+{
+    // Rope-like builder: a list of segments, concatenated only once, at the end. Appended and prepended values
+    // are copied into owned blocks (4 KB, doubling up to 64 KB; consecutive appends extend one segment), while
+    // append_ref()/prepend_ref() just reference chars the caller keeps alive until the builder is flattened or
+    // written (references under 64 bytes are copied instead: cheaper than a segment). str() allocates the result
+    // once, at its exact size; print() and writev() write every segment out as is, without flattening.
+    // wire::builder page; page << "<li>" << item << "</li>"; page.prepend( "<ul>" ); page.writev( fd );
+
+    class builder
+    {
+        public:
+
+        builder() : current( 0 ), cursor( 0 ), current_size( 0 ), room( 0 ), block_size( 4096 ), bytes( 0 )
+        {}
+
+        builder( const builder & ) = delete;
+        builder &operator=( const builder & ) = delete;
+
+        builder( builder &&other ) : builder() {
+            swap( other );
+        }
+
+        builder &operator=( builder &&other ) {
+            builder( std::move( other ) ).swap( *this );
+            return *this;
+        }
+
+        void swap( builder &other ) {
+            list.swap( other.list ), blocks.swap( other.blocks );
+            std::swap( current, other.current ), std::swap( cursor, other.cursor );
+            std::swap( current_size, other.current_size ), std::swap( room, other.room );
+            std::swap( block_size, other.block_size ), std::swap( bytes, other.bytes );
+        }
+
+        // copying
+
+        builder &append( const char *ptr, size_t len ) {
+            if( !len ) return *this;
+            if( len <= room && !list.empty() && list.back().data() + list.back().size() == cursor ) {
+                list.back() = string_view( list.back().data(), list.back().size() + len );
+                std::memcpy( take( len ), ptr, len );
+            } else {
+                char *at = take( len );
+                std::memcpy( at, ptr, len );
+                list.push_back( string_view( at, len ) );
+            }
+            return bytes += len, *this;
+        }
+
+        builder &prepend( const char *ptr, size_t len ) {
+            if( !len ) return *this;
+            char *at = take( len );
+            std::memcpy( at, ptr, len );
+            list.push_front( string_view( at, len ) );
+            return bytes += len, *this;
+        }
+
+        template< typename T >
+        builder &append( const T &t ) {
+            piece p;
+            p.set( t );
+            return append( p.ptr, p.len );
+        }
+
+        template< typename T >
+        builder &prepend( const T &t ) {
+            piece p;
+            p.set( t );
+            return prepend( p.ptr, p.len );
+        }
+
+        template< typename T >
+        builder &operator <<( const T &t ) {
+            return append( t );
+        }
+
+        builder &operator <<( std::ostream &( *pf )(std::ostream &) ) {
+            return *pf == static_cast<std::ostream& ( * )(std::ostream&)>( std::endl ) ? append( "\n", 1 ) : *this;
+        }
+
+        // referencing: text must outlive the builder's str(), print() or writev()
+
+        builder &append_ref( const string_view &text ) {
+            if( text.size() < 64 ) return append( text.data(), text.size() );
+            list.push_back( text );
+            return bytes += text.size(), *this;
+        }
+
+        builder &prepend_ref( const string_view &text ) {
+            if( text.size() < 64 ) return prepend( text.data(), text.size() );
+            list.push_front( text );
+            return bytes += text.size(), *this;
+        }
+
+        // safe formatting (\1..\7, \x10 N), measured first and written once, straight into the owned blocks
+
+        template< typename... Ts >
+        builder &format( const char *fmt, const Ts &... ts ) {
+            return format_args_into( fmt, std::strlen( fmt ), ts... );
+        }
+
+        template< typename... Ts >
+        builder &format( const std::string &fmt, const Ts &... ts ) {
+            return format_args_into( fmt.data(), fmt.size(), ts... );
+        }
+
+        template< typename... Ts >
+        builder &format( const string_view &fmt, const Ts &... ts ) {
+            return format_args_into( fmt.data(), fmt.size(), ts... );
+        }
+
+        template< typename... Ts >
+        builder &format( const wire::fmt &fmt, const Ts &... ts ) {
+            return format_args_into( fmt.str().data(), fmt.str().size(), ts... );
+        }
+
+        // inspection
+
+        size_t size() const {
+            return bytes;
+        }
+
+        bool empty() const {
+            return !bytes;
+        }
+
+        const std::deque< string_view > &segments() const {
+            return list;
+        }
+
+        // drops every segment; the current block is kept for reuse
+        void clear() {
+            list.clear(), bytes = 0;
+            if( !current ) return;
+            for( size_t i = 0; i < blocks.size(); ++i )
+                if( blocks[i].get() == current ) { blocks[i].swap( blocks[0] ); break; }
+            blocks.resize( 1 );
+            cursor = current, room = current_size;
+        }
+
+        // output
+
+        template< typename S >
+        S &append_to( S &out ) const {
+            out.reserve( out.size() + bytes );
+            for( const string_view &s : list ) out.append( s.data(), s.size() );
+            return out;
+        }
+
+        wire::string str() const {
+            wire::string out;
+            append_to( out );
+            return out;
+        }
+
+        // Returns bytes written
+        size_t print( std::ostream &os ) const {
+            size_t written = 0;
+            for( const string_view &s : list ) {
+                if( !os.write( s.data(), std::streamsize( s.size() ) ) ) break;
+                written += s.size();
+            }
+            return written;
+        }
+
+        size_t print( FILE *fp ) const {
+            size_t written = 0;
+            for( const string_view &s : list ) {
+                size_t n = std::fwrite( s.data(), 1, s.size(), fp );
+                written += n;
+                if( n < s.size() ) break;
+            }
+            return written;
+        }
+
+#if WIRE_POSIX
+        // Vectored write of every segment to a file descriptor (WIRE_POSIX), 1024 segments per writev() call;
+        // partial writes are resumed and EINTR is retried. Returns bytes written (short of size() on error)
+        size_t writev( int fd ) const {
+            enum { batch = 1024 };
+            struct iovec io[ batch ];
+            size_t written = 0, next = 0, count = list.size();
+            while( next < count ) {
+                int n = 0;
+                for( ; n < batch && next + n < count; ++n ) {
+                    const string_view &s = list[ next + n ];
+                    io[n].iov_base = (void *)s.data(), io[n].iov_len = s.size();
+                }
+                struct iovec *it = io;
+                while( n ) {
+                    ssize_t done = ::writev( fd, it, n );
+                    if( done < 0 && errno == EINTR ) continue;
+                    if( done <= 0 ) return written;
+                    written += size_t( done );
+                    for( size_t left = size_t( done ); left; ) {
+                        if( left >= it->iov_len ) left -= it->iov_len, ++it, --n, ++next;
+                        else it->iov_base = (char *)it->iov_base + left, it->iov_len -= left, left = 0;
+                    }
+                    while( n && !it->iov_len ) ++it, --n, ++next;
+                }
+            }
+            return written;
+        }
+#endif
+
+        private:
+
+        // room for len more owned bytes at cursor (large ones get a block of their own, so the tail room survives)
+        char *take( size_t len ) {
+            if( len > room ) {
+                if( len > block_size / 2 && room >= 256 ) {
+                    blocks.push_back( std::unique_ptr< char[] >( new char[ len ] ) );
+                    return blocks.back().get();
+                }
+                size_t size = len > block_size ? len : block_size;
+                blocks.push_back( std::unique_ptr< char[] >( new char[ size ] ) );
+                current = cursor = blocks.back().get(), current_size = room = size;
+                if( block_size < 64 * 1024 ) block_size *= 2;
+            }
+            char *at = cursor;
+            cursor += len, room -= len;
+            return at;
+        }
+
+        template< typename... Ts >
+        builder &format_args_into( const char *fmt, size_t len, const Ts &... ts ) {
+            enum { N = sizeof...(Ts) };
+            piece pieces[ N + 1 ];
+            bind( pieces, ts... );
+
+            size_t total = 0, width;
+            for( size_t i = 0; i < len; i += width ) {
+                unsigned slot = slot_at( fmt, len, i, width );
+                total += slot && slot <= N ? pieces[ slot - 1 ].len : width;
+            }
+            if( !total ) return *this;
+
+            // pieces may point into earlier owned bytes; take() only hands out fresh ones
+            bool extends = total <= room && !list.empty() && list.back().data() + list.back().size() == cursor;
+            char *at = take( total ), *w = at;
+            size_t run = 0;
+            for( size_t i = 0; i < len; i += width ) {
+                unsigned slot = slot_at( fmt, len, i, width );
+                if( slot && slot <= N ) {
+                    std::memcpy( w, fmt + run, i - run ), w += i - run;
+                    std::memcpy( w, pieces[ slot - 1 ].ptr, pieces[ slot - 1 ].len ), w += pieces[ slot - 1 ].len;
+                    run = i + width;
+                }
+            }
+            std::memcpy( w, fmt + run, len - run );
+
+            if( extends ) list.back() = string_view( list.back().data(), list.back().size() + total );
+            else list.push_back( string_view( at, total ) );
+            return bytes += total, *this;
+        }
+
+        std::deque< string_view > list;
+        std::vector< std::unique_ptr< char[] > > blocks;
+        char *current, *cursor;
+        size_t current_size, room, block_size, bytes;
+    };
+}
+
+// Interned strings
+
+namespace wire
+{
+    namespace
+    {
+        // 64-bit murmur-style hash over 8-byte words, the tail read as one overlapping word. Not stable across
+        // platforms or versions: do not persist it
+        inline uint64_t rotl64( uint64_t x, int r ) { return ( x << r ) | ( x >> ( 64 - r ) ); }
+        inline uint64_t load64( const char *p ) { uint64_t w; return std::memcpy( &w, p, 8 ), w; }
+        inline uint64_t load32( const char *p ) { uint32_t w; return std::memcpy( &w, p, 4 ), w; }
+
+        inline uint64_t hash_bytes( const char *p, size_t len ) {
+            const uint64_t k1 = 0x87C37B91114253D5ull, k2 = 0x4CF5AD432745937Full;
+            const char *end = p + len;
+            uint64_t h = len * 0x9E3779B97F4A7C15ull, w = 0;
+            if( len >= 8 ) {
+                for( ; end - p > 8; p += 8 ) {
+                    h ^= rotl64( load64( p ) * k1, 31 ) * k2;
+                    h = rotl64( h, 27 ) * 5 + 0x52DCE729;
+                }
+                w = load64( end - 8 );
+            }
+            else if( len >= 4 ) w = load32( p ) << 32 | load32( end - 4 );
+            else if( len ) w = uint64_t( (unsigned char)p[0] ) << 16 | uint64_t( (unsigned char)p[len / 2] ) << 8 | (unsigned char)end[-1];
+            h ^= rotl64( w * k1, 31 ) * k2;
+            h ^= h >> 33, h *= 0xFF51AFD7ED558CCDull;
+            h ^= h >> 33, h *= 0xC4CEB9FE1A85EC53ull;
+            return h ^ ( h >> 33 );
+        }
+    }
+
+    // Interned string: every distinct text is stored once in a process-wide table that is never freed, and an atom
+    // is a pointer to its entry. Equality, hashing and ordering (by id, i.e. interning order) are O(1); the hash is
+    // computed once, when a text is first interned. Interning takes a lock and a lookup, so build atoms once for a
+    // bounded set of keys (header names, metric names...) and keep them. Ids are dense, starting at 0 (the empty atom).
+    // static const wire::atom content_type( "content-type" ); if( wire::atom( header ) == content_type ) ...
+
+    class atom
+    {
+        struct entry {
+            std::string text;
+            size_t hash;
+            unsigned id;
+        };
+
+        public:
+
+        atom() : e( &table().entries.front() )
+        {}
+
+        explicit atom( const string_view &text ) : e( table().intern( text ) )
+        {}
+
+        // any std::basic_string<char>; for wire strings this beats both the view and their operator T()
+        template< typename A >
+        explicit atom( const std::basic_string< char, std::char_traits< char >, A > &text ) : e( table().intern( text ) )
+        {}
+
+        const std::string &str() const { return e->text; }
+        string_view view() const { return e->text; }
+        const char *c_str() const { return e->text.c_str(); }
+        size_t size() const { return e->text.size(); }
+        bool empty() const { return e->text.empty(); }
+        size_t hash() const { return e->hash; }
+        unsigned id() const { return e->id; }
+
+        // atoms interned so far, the empty one included
+        static size_t count() {
+            std::lock_guard< std::mutex > lock( table().mutex );
+            return table().entries.size();
+        }
+
+        friend bool operator ==( const atom &a, const atom &b ) { return a.e == b.e; }
+        friend bool operator !=( const atom &a, const atom &b ) { return a.e != b.e; }
+        friend bool operator <( const atom &a, const atom &b ) { return a.e->id < b.e->id; }
+
+        friend bool operator ==( const atom &a, const string_view &b ) { return a.view() == b; }
+        friend bool operator !=( const atom &a, const string_view &b ) { return a.view() != b; }
+
+        friend std::ostream &operator <<( std::ostream &os, const atom &a ) { return os << a.e->text; }
+
+        private:
+
+        struct view_hash {
+            size_t operator()( const string_view &v ) const { return size_t( hash_bytes( v.data(), v.size() ) ); }
+        };
+
+        struct registry {
+            std::mutex mutex;
+            std::deque< entry > entries;   // stable addresses: index keys view entry texts
+            std::unordered_map< string_view, const entry *, view_hash > index;
+
+            registry() {
+                intern( string_view() );
+            }
+
+            const entry *intern( const string_view &text ) {
+                size_t hash = view_hash()( text );
+                std::lock_guard< std::mutex > lock( mutex );
+                auto found = index.find( text );
+                if( found != index.end() ) return found->second;
+                entry fresh = { std::string( text.data(), text.size() ), hash, unsigned( entries.size() ) };
+                entries.push_back( std::move( fresh ) );
+                return index.emplace( string_view( entries.back().text ), &entries.back() ).first->second;
+            }
+        };
+
+        // leaked on purpose: atoms stay valid during static destruction
+        static registry &table() {
+            static registry *instance = new registry;
+            return *instance;
+        }
+
+        const entry *e;
+    };
+
+    namespace
+    {
+        // wire::string( "host" ).as< wire::atom >(), and what its operator T() yields
+        template<>
+        inline atom as( const char *begin, const char *end ) {
+            return atom( string_view( begin, size_t( end - begin ) ) );
+        }
+    }
+}
+
+// std::hash for unordered containers: atoms return their cached hash; strings and views hash their bytes
+
+namespace std
+{
+    template<>
+    struct hash< wire::atom > {
+        size_t operator()( const wire::atom &a ) const { return a.hash(); }
+    };
+
+    template<>
+    struct hash< wire::string_view > {
+        size_t operator()( const wire::string_view &v ) const { return size_t( wire::hash_bytes( v.data(), v.size() ) ); }
+    };
+
+    template< typename Alloc >
+    struct hash< wire::basic_string< Alloc > > {
+        size_t operator()( const wire::basic_string< Alloc > &s ) const { return size_t( wire::hash_bytes( s.data(), s.size() ) ); }
+    };
+
+    template< size_t N >
+    struct hash< wire::small_string< N > > {
+        size_t operator()( const wire::small_string< N > &s ) const { return size_t( wire::hash_bytes( s.data(), s.size() ) ); }
+    };
+}
+
+// $wire(), introspective macro
+
+namespace wire
+{
+    // builds the $wire() skeleton: fmt repeated per argument, \1 = argument name, \2 = argument slot
+    struct parser : public wire::string {
+        parser( const wire::string &fmt, const wire::string &line = std::string() ) {
+            wire::strings all = line.tokenize(", \r\n\t");
+            wire::strings::iterator it, begin, end;
+
+            typedef std::pair<std::string,std::string> pair;
+            std::vector< pair > results;
+
+            for( it = begin = all.begin(), end = all.end(); it != end; ++it ) {
+                results.push_back( pair( (*it).right_of(".").right_of("->"), wire::fmt::slot( unsigned(it - begin + 1) ) ) );
+            }
+
+            assign( str12(results, fmt) );
+        }
+    };
+
+    // $wire() call site cache: the skeleton is parsed once per thread and call site, so every call only formats
+    // its values. Rebuilt only when the call site is given a different format.
+    class introspection {
+        std::string format;
+        wire::fmt skeleton;
+        bool ready;
+
+        public:
+
+        introspection() : skeleton( std::string() ), ready( false )
+        {}
+
+        const wire::fmt &prepare( const string_view &fmt, const char *names ) {
+            if( !ready || fmt != string_view( format ) ) {
+                format.assign( fmt.data(), fmt.size() );
+                parser line( format, names );
+                skeleton = wire::fmt( static_cast< const std::string & >( line ) );
+                ready = true;
+            }
+            return skeleton;
+        }
+    };
+}
+
+// ", ##" drops the comma when no argument follows (gcc, clang; msvc elides it already): $wire( fmt ) is empty
+#define $wire(FMT,...) wire::string( []( const wire::string_view &fmt ) -> const wire::fmt & { \
+    static thread_local wire::introspection site; return site.prepare( fmt, #__VA_ARGS__ ); }( FMT ), ##__VA_ARGS__ )
+
+#ifdef _MSC_VER
+#    pragma warning( pop )
+#endif
+#undef wire$snprintf
+#undef wire$vsnprintf
+#undef wire$probe
+#undef wire$probe_on
+#undef wire$probe_list_on
+#undef wire$probe_result
+#undef wire$probe_result_list
+#undef WIRE_SSE2
+#undef WIRE_NEON
+#undef WIRE_AVX2
+#undef WIRE_AVX2_TARGET